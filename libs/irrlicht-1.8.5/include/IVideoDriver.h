@@ -315,6 +315,8 @@ namespace video
 		Version (int) Version of the driver. Should be Major*100+Minor
 		ShaderLanguageVersion (int) Version of the high level shader language. Should be Major*100+Minor.
 		AntiAlias (int) Number of Samples the driver uses for each pixel. 0 and 1 means anti aliasing is off, typical values are 2,4,8,16,32
+		DrawCalls (int) Number of primitive lists drawn since the last beginScene(), in 2d and 3d.
+		PrimitivesDrawn (int) Number of primitives in them. Unlike getPrimitiveCountDrawn() this is already up to date before endScene().
 		*/
 		virtual const io::IAttributes& getDriverAttributes() const=0;
 
@@ -174,6 +174,29 @@ namespace scene
 	**/
 	const c8* const DEBUG_NORMAL_COLOR = "DEBUG_Normal_Color";
 
+	//! Name of the parameter counting shadow volume rebuilds.
+	/** Every shadow volume scene node adds one to it whenever it has to
+	rebuild its volumes. The scene manager never resets it, so read and reset
+	it like this:
+	\code
+	io::IAttributes* params = SceneManager->getParameters();
+	s32 rebuilds = params->getAttributeAsInt(scene::SHADOW_VOLUME_REBUILDS);
+	params->setAttribute(scene::SHADOW_VOLUME_REBUILDS, 0);
+	\endcode
+	**/
+	const c8* const SHADOW_VOLUME_REBUILDS = "SHADOW_Volume_Rebuilds";
+
+	//! Name of the parameter counting shadow volumes reused unchanged.
+	/** Volumes are reused when neither the mesh pose nor the light position
+	relative to the node changed. Counted like SHADOW_VOLUME_REBUILDS. **/
+	const c8* const SHADOW_VOLUME_REUSES = "SHADOW_Volume_Reuses";
+
+	//! Name of the parameter counting shadow volume adjacency calculations.
+	/** Adjacency is shared by all shadow volumes using the same mesh, so only
+	the first one to see a mesh calculates it. Counted like
+	SHADOW_VOLUME_REBUILDS. **/
+	const c8* const SHADOW_VOLUME_ADJACENCY_BUILDS = "SHADOW_Volume_Adjacency_Builds";
+
 
 } // end namespace scene
 } // end namespace irr
@@ -9,6 +9,19 @@
 #include "SColor.h"
 #include "irrMath.h"
 
+// SIMD interpolation: SSE2 on x86-64 (and x86 with SSE2 enabled), AVX2 when
+// the compiler targets it (/arch:AVX2, -mavx2). Define _IRR_MD2_NO_SIMD_ to
+// build the scalar SoA loop instead.
+#if !defined(_IRR_MD2_NO_SIMD_)
+#if defined(__AVX2__)
+#define _IRR_MD2_AVX2_
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _IRR_MD2_SSE2_
+#include <emmintrin.h>
+#endif
+#endif
+
 namespace irr
 {
 namespace scene
@@ -219,7 +232,7 @@ static const SMD2AnimationType MD2AnimationTypeList[21] =
 
 //! constructor
 CAnimatedMeshMD2::CAnimatedMeshMD2()
-	: InterpolationBuffer(0), FrameList(0), FrameCount(0), FramesPerSecond((f32)(MD2AnimationTypeList[0].fps << MD2_FRAME_SHIFT))
+	: InterpolationBuffer(0), FrameList(0), FrameCount(0), FrameSoAStride(0), FramesPerSecond((f32)(MD2AnimationTypeList[0].fps << MD2_FRAME_SHIFT))
 {
 	#ifdef _DEBUG
 	IAnimatedMesh::setDebugName("CAnimatedMeshMD2 IAnimatedMesh");
@@ -320,6 +333,16 @@ void CAnimatedMeshMD2::updateInterpolationBuffer(s32 frame, s32 startFrameLoop,
 		div = frame * MD2_FRAME_SHIFT_RECIPROCAL;
 	}
 
+	//update bounding box
+	InterpolationBuffer->setBoundingBox(BoxList[secondFrame].getInterpolated(BoxList[firstFrame], div));
+	InterpolationBuffer->setDirty();
+
+	if (FrameSoAStride)
+	{
+		interpolateSoA(firstFrame, secondFrame, div);
+		return;
+	}
+
 	video::S3DVertex* target = static_cast<video::S3DVertex*>(InterpolationBuffer->getVertices());
 	SMD2Vert* first = FrameList[firstFrame].pointer();
 	SMD2Vert* second = FrameList[secondFrame].pointer();
@@ -348,10 +371,95 @@ void CAnimatedMeshMD2::updateInterpolationBuffer(s32 frame, s32 startFrameLoop,
 		++first;
 		++second;
 	}
+}
 
-	//update bounding box
-	InterpolationBuffer->setBoundingBox(BoxList[secondFrame].getInterpolated(BoxList[firstFrame], div));
-	InterpolationBuffer->setDirty();
+
+//! pre-converts the packed frame vertices for interpolateSoA
+void CAnimatedMeshMD2::buildFrameSoA()
+{
+	const u32 count = FrameCount ? FrameList[0].size() : 0;
+	FrameSoAStride = (count + 7) & ~7u;
+	FrameSoA.set_used(FrameCount * 6 * FrameSoAStride);
+
+	for (u32 f=0; f<FrameCount; ++f)
+	{
+		f32* posX = FrameSoA.pointer() + f * 6 * FrameSoAStride;
+		f32* posY = posX + FrameSoAStride;
+		f32* posZ = posY + FrameSoAStride;
+		f32* normalX = posZ + FrameSoAStride;
+		f32* normalY = normalX + FrameSoAStride;
+		f32* normalZ = normalY + FrameSoAStride;
+
+		const SKeyFrameTransform& t = FrameTransforms[f];
+		const SMD2Vert* v = FrameList[f].const_pointer();
+		for (u32 i=0; i<FrameSoAStride; ++i)
+		{
+			if (i < count)
+			{
+				posX[i] = f32(v[i].Pos.X) * t.scale.X + t.translate.X;
+				posY[i] = f32(v[i].Pos.Y) * t.scale.Y + t.translate.Y;
+				posZ[i] = f32(v[i].Pos.Z) * t.scale.Z + t.translate.Z;
+				normalX[i] = Q2_VERTEX_NORMAL_TABLE[v[i].NormalIdx][0];
+				normalY[i] = Q2_VERTEX_NORMAL_TABLE[v[i].NormalIdx][2];
+				normalZ[i] = Q2_VERTEX_NORMAL_TABLE[v[i].NormalIdx][1];
+			}
+			else
+			{
+				posX[i] = posY[i] = posZ[i] = 0.f;
+				normalX[i] = normalY[i] = normalZ[i] = 0.f;
+			}
+		}
+	}
+}
+
+
+//! lerps positions and normals of two frames from FrameSoA into the interpolation buffer
+void CAnimatedMeshMD2::interpolateSoA(u32 firstFrame, u32 secondFrame, f32 div)
+{
+	const u32 stride = FrameSoAStride;
+	const f32* a = FrameSoA.const_pointer() + firstFrame * 6 * stride;
+	const f32* b = FrameSoA.const_pointer() + secondFrame * 6 * stride;
+	const u32 count = FrameList[firstFrame].size();
+	video::S3DVertex* target = static_cast<video::S3DVertex*>(InterpolationBuffer->getVertices());
+
+#if defined(_IRR_MD2_AVX2_)
+	const u32 lanes = 8;
+	const __m256 d = _mm256_set1_ps(div);
+#elif defined(_IRR_MD2_SSE2_)
+	const u32 lanes = 4;
+	const __m128 d = _mm_set1_ps(div);
+#else
+	const u32 lanes = 4;
+#endif
+
+	f32 out[6][8];
+	for (u32 i=0; i<count; i+=lanes)
+	{
+		// out = a + (b - a) * div, one component array at a time
+		for (u32 c=0; c<6; ++c)
+		{
+			const f32* ca = a + c * stride + i;
+			const f32* cb = b + c * stride + i;
+#if defined(_IRR_MD2_AVX2_)
+			const __m256 va = _mm256_loadu_ps(ca);
+			_mm256_storeu_ps(out[c], _mm256_add_ps(va, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(cb), va), d)));
+#elif defined(_IRR_MD2_SSE2_)
+			const __m128 va = _mm_loadu_ps(ca);
+			_mm_storeu_ps(out[c], _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(cb), va), d)));
+#else
+			for (u32 k=0; k<lanes; ++k)
+				out[c][k] = ca[k] + (cb[k] - ca[k]) * div;
+#endif
+		}
+
+		// back to the S3DVertex layout the drivers expect
+		const u32 n = core::min_(lanes, count - i);
+		for (u32 k=0; k<n; ++k, ++target)
+		{
+			target->Pos.set(out[0][k], out[1][k], out[2][k]);
+			target->Normal.set(out[3][k], out[4][k], out[5][k]);
+		}
+	}
 }
 
 
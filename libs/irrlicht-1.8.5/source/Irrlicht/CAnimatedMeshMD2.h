@@ -139,10 +139,20 @@ namespace scene
 
 		u32 FrameCount;
 
+		//! Converts FrameList to FrameSoA. Called by the loader once all frames are read.
+		void buildFrameSoA();
+
+		//! Per frame: transformed positions and unpacked normals as six float
+		//! arrays (X, Y, Z, NX, NY, NZ) of FrameSoAStride entries each, padded
+		//! with zeros to a multiple of 8 so the SIMD loops need no tail.
+		core::array<f32> FrameSoA;
+		u32 FrameSoAStride;
+
 	private:
 
 		//! updates the interpolation buffer
 		void updateInterpolationBuffer(s32 frame, s32 startFrame, s32 endFrame);
+		void interpolateSoA(u32 firstFrame, u32 secondFrame, f32 div);
 
 		f32 FramesPerSecond;
 	};
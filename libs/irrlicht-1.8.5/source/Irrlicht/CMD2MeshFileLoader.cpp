@@ -352,6 +352,8 @@ bool CMD2MeshFileLoader::loadFile(io::IReadFile* file, CAnimatedMeshMD2* mesh)
 	delete [] triangles;
 	delete [] textureCoords;
 
+	mesh->buildFrameSoA();
+
 	// init buffer with start frame.
 	mesh->getMesh(0);
 	return true;
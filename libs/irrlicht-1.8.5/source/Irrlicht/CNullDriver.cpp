@@ -83,7 +83,7 @@ IImageWriter* createImageWriterPPM();
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
 : FileSystem(io), MeshManipulator(0), ViewPort(0,0,0,0), ScreenSize(screenSize),
-	PrimitivesDrawn(0), MinVertexCountForVBO(500), TextureCreationFlags(0),
+	PrimitivesDrawn(0), DrawCalls(0), MinVertexCountForVBO(500), TextureCreationFlags(0),
 	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
 {
 	#ifdef _DEBUG
@@ -105,6 +105,10 @@ CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& scre
 	DriverAttributes->addInt("Version", 1);
 //	DriverAttributes->addInt("ShaderLanguageVersion", 0);
 //	DriverAttributes->addInt("AntiAlias", 0);
+	DriverAttributes->addInt("DrawCalls", 0);
+	DrawCallsAttribute = DriverAttributes->findAttribute("DrawCalls");
+	DriverAttributes->addInt("PrimitivesDrawn", 0);
+	PrimitivesDrawnAttribute = DriverAttributes->findAttribute("PrimitivesDrawn");
 
 	setFog();
 
@@ -303,6 +307,9 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 {
 	core::clearFPUException();
 	PrimitivesDrawn = 0;
+	DrawCalls = 0;
+	DriverAttributes->setAttribute(DrawCallsAttribute, 0);
+	DriverAttributes->setAttribute(PrimitivesDrawnAttribute, 0);
 	return true;
 }
 
@@ -646,7 +653,18 @@ void CNullDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
 {
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
+	countDrawCall(primitiveCount);
+}
+
+
+//! adds a draw call to the counters of the current frame
+void CNullDriver::countDrawCall(u32 primitiveCount)
+{
 	PrimitivesDrawn += primitiveCount;
+	++DrawCalls;
+	// published right away, so they can be read before endScene()
+	DriverAttributes->setAttribute(DrawCallsAttribute, (s32)DrawCalls);
+	DriverAttributes->setAttribute(PrimitivesDrawnAttribute, (s32)PrimitivesDrawn);
 }
 
 
@@ -655,7 +673,7 @@ void CNullDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCoun
 {
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
-	PrimitivesDrawn += primitiveCount;
+	countDrawCall(primitiveCount);
 }
 
 
@@ -682,6 +682,9 @@ namespace video
 		//! checks triangle count and print warning if wrong
 		bool checkPrimitiveCount(u32 prmcnt) const;
 
+		//! adds a draw call to the counters of the current frame
+		void countDrawCall(u32 primitiveCount);
+
 		// adds a material renderer and drops it afterwards. To be used for internal creation
 		s32 addAndDropMaterialRenderer(IMaterialRenderer* m);
 
@@ -829,6 +832,10 @@ namespace video
 		CFPSCounter FPSCounter;
 
 		u32 PrimitivesDrawn;
+		u32 DrawCalls;
+		//! indices of the DrawCalls and PrimitivesDrawn driver attributes
+		s32 DrawCallsAttribute;
+		s32 PrimitivesDrawnAttribute;
 		u32 MinVertexCountForVBO;
 
 		u32 TextureCreationFlags;
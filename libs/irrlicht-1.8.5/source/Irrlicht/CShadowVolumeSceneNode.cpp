@@ -7,8 +7,12 @@
 #include "IMesh.h"
 #include "IVideoDriver.h"
 #include "ICameraSceneNode.h"
+#include "IAnimatedMeshSceneNode.h"
+#include "IAttributes.h"
+#include "SceneParameters.h"
 #include "SViewFrustum.h"
 #include "SLight.h"
+#include "irrMap.h"
 #include "os.h"
 
 namespace irr
@@ -16,12 +20,45 @@ namespace irr
 namespace scene
 {
 
+//! How far a light may move, relative to its distance, before volumes built
+//! for the old position are rebuilt
+const f32 LightReuseTolerance = 0.005f;
+
+
+//! Adjacency depends only on the mesh topology, so it is calculated once per
+//! mesh and shared by all shadow nodes using it. Entries remove themselves
+//! from the cache when the last node drops them.
+struct CShadowVolumeSceneNode::SAdjacency : public IReferenceCounted
+{
+	SAdjacency(const IMesh* mesh) : Mesh(mesh), IndexCount(0), VertexCount(0)
+	{
+		getCache().insert(Mesh, this);
+	}
+
+	virtual ~SAdjacency()
+	{
+		getCache().remove(Mesh);
+	}
+
+	static core::map<const IMesh*, SAdjacency*>& getCache()
+	{
+		static core::map<const IMesh*, SAdjacency*> cache;
+		return cache;
+	}
+
+	const IMesh* Mesh;
+	u32 IndexCount;
+	u32 VertexCount;
+	core::array<u16> Faces;
+};
+
 
 //! constructor
 CShadowVolumeSceneNode::CShadowVolumeSceneNode(const IMesh* shadowMesh, ISceneNode* parent,
 		ISceneManager* mgr, s32 id, bool zfailmethod, f32 infinity)
 : IShadowVolumeSceneNode(parent, mgr, id),
-	ShadowMesh(0), IndexCount(0), VertexCount(0), ShadowVolumesUsed(0),
+	Adjacency(0), ShadowMesh(0), VolumesValid(false),
+	IndexCount(0), VertexCount(0), ShadowVolumesUsed(0),
 	Infinity(infinity), UseZFailMethod(zfailmethod)
 {
 	#ifdef _DEBUG
@@ -35,6 +72,7 @@ CShadowVolumeSceneNode::CShadowVolumeSceneNode(const IMesh* shadowMesh, ISceneNo
 //! destructor
 CShadowVolumeSceneNode::~CShadowVolumeSceneNode()
 {
+	releaseAdjacency();
 	if (ShadowMesh)
 		ShadowMesh->drop();
 }
@@ -160,9 +198,9 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
 			const u16 wFace1 = Indices[3*i+1];
 			const u16 wFace2 = Indices[3*i+2];
 
-			const u16 adj0 = Adjacency[3*i+0];
-			const u16 adj1 = Adjacency[3*i+1];
-			const u16 adj2 = Adjacency[3*i+2];
+			const u16 adj0 = Adjacency->Faces[3*i+0];
+			const u16 adj1 = Adjacency->Faces[3*i+1];
+			const u16 adj2 = Adjacency->Faces[3*i+2];
 
 			// add edges if face is adjacent to back-facing face
 			// or if no adjacent face was found
@@ -205,6 +243,8 @@ void CShadowVolumeSceneNode::setShadowMesh(const IMesh* mesh)
 {
 	if (ShadowMesh == mesh)
 		return;
+	releaseAdjacency();
+	VolumesValid = false;
 	if (ShadowMesh)
 		ShadowMesh->drop();
 	ShadowMesh = mesh;
@@ -216,21 +256,114 @@ void CShadowVolumeSceneNode::setShadowMesh(const IMesh* mesh)
 }
 
 
-void CShadowVolumeSceneNode::updateShadowVolumes()
+void CShadowVolumeSceneNode::releaseAdjacency()
+{
+	if (Adjacency)
+		Adjacency->drop();
+	Adjacency = 0;
+}
+
+
+void CShadowVolumeSceneNode::countStat(const c8* name) const
+{
+	io::IAttributes* params = SceneManager->getParameters();
+	params->setAttribute(name, params->getAttributeAsInt(name) + 1);
+}
+
+
+CShadowVolumeSceneNode::SPose CShadowVolumeSceneNode::getPose() const
+{
+	SPose pose = { 0, 0, 0, 0, 0 };
+
+	// same frame quantization as CAnimatedMeshSceneNode::getMeshForCurrentFrame
+	if (Parent && Parent->getType() == ESNT_ANIMATED_MESH)
+	{
+		IAnimatedMeshSceneNode* node = static_cast<IAnimatedMeshSceneNode*>(Parent);
+		const IAnimatedMesh* animated = node->getMesh();
+		const f32 frame = node->getFrameNr();
+
+		if (animated && animated->getMeshType() == EAMT_SKINNED)
+			pose.Frame = (s32)core::IR(frame);
+		else
+		{
+			pose.Frame = (s32)frame;
+			// MD2 interpolates on the frame number alone
+			if (!animated || animated->getMeshType() != EAMT_MD2)
+				pose.FrameBlend = (s32)(core::fract(frame) * 1000.f);
+		}
+		pose.StartFrame = node->getStartFrame();
+		pose.EndFrame = node->getEndFrame();
+	}
+	else
+	{
+		// catches edits of static meshes; animated meshes mark their
+		// buffers dirty on every interpolation, so the frame is used there
+		for (u32 i=0; i<ShadowMesh->getMeshBufferCount(); ++i)
+		{
+			const IMeshBuffer* buf = ShadowMesh->getMeshBuffer(i);
+			pose.ChangedID += buf->getChangedID_Vertex() + buf->getChangedID_Index();
+		}
+	}
+	return pose;
+}
+
+
+bool CShadowVolumeSceneNode::canReuseVolumes(const SPose& pose) const
 {
-	const u32 oldIndexCount = IndexCount;
-	const u32 oldVertexCount = VertexCount;
+	if (!VolumesValid || !(pose == VolumePose) || Lights.size() != VolumeLights.size())
+		return false;
 
+	for (u32 i=0; i<Lights.size(); ++i)
+	{
+		const f32 tolerance = VolumeLights[i].getLength() * LightReuseTolerance;
+		if (Lights[i].getDistanceFromSQ(VolumeLights[i]) > tolerance*tolerance)
+			return false;
+	}
+	return true;
+}
+
+
+void CShadowVolumeSceneNode::updateShadowVolumes()
+{
+	// hidden volumes are not drawn, so don't build them either
 	const IMesh* const mesh = ShadowMesh;
-	if (!mesh)
+	if (!mesh || !IsVisible)
 		return;
 
 	// create as much shadow volumes as there are lights but
 	// do not ignore the max light settings.
-	const u32 lightCount = SceneManager->getVideoDriver()->getDynamicLightCount();
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	const u32 lightCount = driver->getDynamicLightCount();
 	if (!lightCount)
 		return;
 
+	core::matrix4 mat = Parent->getAbsoluteTransformation();
+	mat.makeInverse();
+	const core::vector3df parentpos = Parent->getAbsolutePosition();
+
+	// TODO: Only correct for point lights.
+	Lights.set_used(0);
+	for (u32 i=0; i<lightCount; ++i)
+	{
+		const video::SLight& dl = driver->getDynamicLight(i);
+		core::vector3df lpos = dl.Position;
+		if (dl.CastShadows &&
+			fabs((lpos - parentpos).getLengthSQ()) <= (dl.Radius*dl.Radius*4.0f))
+		{
+			mat.transformVect(lpos);
+			Lights.push_back(lpos);
+		}
+	}
+
+	// the silhouettes only change with the mesh pose and the light
+	// position relative to the node
+	const SPose pose = getPose();
+	if (canReuseVolumes(pose))
+	{
+		countStat(SHADOW_VOLUME_REUSES);
+		return;
+	}
+
 	// calculate total amount of vertices and indices
 
 	VertexCount = 0;
@@ -270,26 +403,33 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 			Vertices[VertexCount++] = buf->getPosition(j);
 	}
 
-	// recalculate adjacency if necessary
-	if (oldVertexCount != VertexCount || oldIndexCount != IndexCount)
-		calculateAdjacency();
-
-	core::matrix4 mat = Parent->getAbsoluteTransformation();
-	mat.makeInverse();
-	const core::vector3df parentpos = Parent->getAbsolutePosition();
-
-	// TODO: Only correct for point lights.
-	for (i=0; i<lightCount; ++i)
+	// fetch the shared adjacency, recalculate it if the mesh changed
+	if (!Adjacency)
 	{
-		const video::SLight& dl = SceneManager->getVideoDriver()->getDynamicLight(i);
-		core::vector3df lpos = dl.Position;
-		if (dl.CastShadows &&
-			fabs((lpos - parentpos).getLengthSQ()) <= (dl.Radius*dl.Radius*4.0f))
+		core::map<const IMesh*, SAdjacency*>::Node* cached = SAdjacency::getCache().find(mesh);
+		if (cached)
 		{
-			mat.transformVect(lpos);
-			createShadowVolume(lpos);
+			Adjacency = cached->getValue();
+			Adjacency->grab();
 		}
+		else
+			Adjacency = new SAdjacency(mesh);
 	}
+	if (Adjacency->VertexCount != VertexCount || Adjacency->IndexCount != IndexCount)
+	{
+		calculateAdjacency(Adjacency->Faces);
+		Adjacency->VertexCount = VertexCount;
+		Adjacency->IndexCount = IndexCount;
+		countStat(SHADOW_VOLUME_ADJACENCY_BUILDS);
+	}
+
+	for (i=0; i<Lights.size(); ++i)
+		createShadowVolume(Lights[i]);
+
+	VolumeLights = Lights;
+	VolumePose = pose;
+	VolumesValid = true;
+	countStat(SHADOW_VOLUME_REBUILDS);
 }
 
 
@@ -367,9 +507,9 @@ const core::aabbox3d<f32>& CShadowVolumeSceneNode::getBoundingBox() const
 
 
 //! Generates adjacency information based on mesh indices.
-void CShadowVolumeSceneNode::calculateAdjacency()
+void CShadowVolumeSceneNode::calculateAdjacency(core::array<u16>& adjacency)
 {
-	Adjacency.set_used(IndexCount);
+	adjacency.set_used(IndexCount);
 
 	// go through all faces and fetch their three neighbours
 	for (u32 f=0; f<IndexCount; f+=3)
@@ -407,9 +547,9 @@ void CShadowVolumeSceneNode::calculateAdjacency()
 
 			// no adjacent edges -> store face number, else store adjacent face
 			if (of >= IndexCount)
-				Adjacency[f + edge] = f/3;
+				adjacency[f + edge] = f/3;
 			else
-				Adjacency[f + edge] = of/3;
+				adjacency[f + edge] = of/3;
 		}
 	}
 }
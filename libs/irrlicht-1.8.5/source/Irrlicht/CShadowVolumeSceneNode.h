@@ -49,11 +49,35 @@ namespace scene
 
 		typedef core::array<core::vector3df> SShadowVolume;
 
+		struct SAdjacency;
+
+		//! What the volumes were built from: the parent's animation frame
+		//! as its mesh sees it and the change ids of the mesh buffers
+		struct SPose
+		{
+			s32 Frame, FrameBlend, StartFrame, EndFrame;
+			u32 ChangedID;
+
+			bool operator==(const SPose& other) const
+			{
+				return Frame == other.Frame && FrameBlend == other.FrameBlend &&
+					StartFrame == other.StartFrame && EndFrame == other.EndFrame &&
+					ChangedID == other.ChangedID;
+			}
+		};
+
+		SPose getPose() const;
+		bool canReuseVolumes(const SPose& pose) const;
+		void releaseAdjacency();
+
+		//! Adds one to a SHADOW_VOLUME_* counter in the scene parameters
+		void countStat(const c8* name) const;
+
 		void createShadowVolume(const core::vector3df& pos, bool isDirectional=false);
 		u32 createEdgesAndCaps(const core::vector3df& light, SShadowVolume* svp, core::aabbox3d<f32>* bb);
 
 		//! Generates adjacency information based on mesh indices.
-		void calculateAdjacency();
+		void calculateAdjacency(core::array<u16>& adjacency);
 
 		core::aabbox3d<f32> Box;
 
@@ -65,13 +89,21 @@ namespace scene
 
 		core::array<core::vector3df> Vertices;
 		core::array<u16> Indices;
-		core::array<u16> Adjacency;
+		// shared by all nodes using ShadowMesh
+		SAdjacency* Adjacency;
 		core::array<u16> Edges;
 		// tells if face is front facing
 		core::array<bool> FaceData;
 
 		const scene::IMesh* ShadowMesh;
 
+		// object space light position of every volume, and the lights of
+		// the current update
+		core::array<core::vector3df> VolumeLights;
+		core::array<core::vector3df> Lights;
+		SPose VolumePose;
+		bool VolumesValid;
+
 		u32 IndexCount;
 		u32 VertexCount;
 		u32 ShadowVolumesUsed;
@@ -2499,15 +2499,24 @@ void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 //! driver, it would return "Direct3D8.1".
 const wchar_t* CBurningVideoDriver::getName() const
 {
+	// tells benchmark logs which span kernels the library was built with
+#ifdef SOFTWARE_DRIVER_2_SSE2
+	#define BURNINGVIDEO_SPAN_NAME L" sse2"
+#else
+	#define BURNINGVIDEO_SPAN_NAME L""
+#endif
+
 #ifdef BURNINGVIDEO_RENDERER_BEAUTIFUL
-	return L"Burning's Video 0.47 beautiful";
+	return L"Burning's Video 0.47 beautiful" BURNINGVIDEO_SPAN_NAME;
 #elif defined ( BURNINGVIDEO_RENDERER_ULTRA_FAST )
-	return L"Burning's Video 0.47 ultra fast";
+	return L"Burning's Video 0.47 ultra fast" BURNINGVIDEO_SPAN_NAME;
 #elif defined ( BURNINGVIDEO_RENDERER_FAST )
-	return L"Burning's Video 0.47 fast";
+	return L"Burning's Video 0.47 fast" BURNINGVIDEO_SPAN_NAME;
 #else
-	return L"Burning's Video 0.47";
+	return L"Burning's Video 0.47" BURNINGVIDEO_SPAN_NAME;
 #endif
+
+#undef BURNINGVIDEO_SPAN_NAME
 }
 
 //! Returns the graphics card vendor name.
@@ -7,6 +7,8 @@
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
+#include "CSoftwareDriver2.h"
+
 // compile flag for this file
 #undef USE_ZBUFFER
 #undef IPOL_Z
@@ -68,6 +70,14 @@
 
 #endif
 
+// SSE2 span kernel, four pixels per step, for the configuration the renderer
+// is built with by default (32 bit, W-buffer, perspective correct, vertex color)
+#undef BURNING_SPAN_SSE2
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( CMP_W ) && defined ( WRITE_W ) && defined ( INVERSE_W ) && defined ( IPOL_C0 )
+	#define BURNING_SPAN_SSE2
+	#include <emmintrin.h>
+#endif
+
 
 namespace irr
 {
@@ -85,23 +95,76 @@ public:
 	//! draws an indexed triangle list
 	virtual void drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c );
 
+	virtual void setMaterial ( const SBurningShaderMaterial &material );
 
 private:
 	void scanline_bilinear ();
 	sScanConvertData scan;
 	sScanLineData line;
 
+	// linear per pixel fog, depth taken from the interpolated 1/w
+	bool Fog;
+	f32 FogEnd;
+	f32 FogScale;		// 1 / (end - start)
+	f32 FogColor[3];	// r, g, b in color fixpoint
+
 };
 
 //! constructor
 CTRTextureGouraud2::CTRTextureGouraud2(CBurningVideoDriver* driver)
-: IBurningShader(driver)
+: IBurningShader(driver), Fog(false), FogEnd(0.f), FogScale(0.f)
 {
 	#ifdef _DEBUG
 	setDebugName("CTRTextureGouraud2");
 	#endif
+	FogColor[0] = FogColor[1] = FogColor[2] = 0.f;
+}
+
+/*!
+	the driver stores the fog state but doesn't apply it; pick it up here so
+	fogged materials fade like on the hardware drivers. Only linear fog.
+*/
+void CTRTextureGouraud2::setMaterial ( const SBurningShaderMaterial &material )
+{
+	SColor color;
+	E_FOG_TYPE type;
+	f32 start, end, density;
+	bool pixelFog, rangeFog;
+	Driver->getFog ( color, type, start, end, density, pixelFog, rangeFog );
+
+	Fog = material.org.FogEnable && type == EFT_FOG_LINEAR && end > start;
+	FogEnd = end;
+	FogScale = Fog ? core::reciprocal ( end - start ) : 0.f;
+	FogColor[0] = (f32) color.getRed() * FIX_POINT_F32_MUL;
+	FogColor[1] = (f32) color.getGreen() * FIX_POINT_F32_MUL;
+	FogColor[2] = (f32) color.getBlue() * FIX_POINT_F32_MUL;
 }
 
+#ifdef BURNING_SPAN_SSE2
+
+// low 32 bits of a 32 x 32 multiply; SSE2 has no pmulld
+static inline __m128i mullo_epi32_sse2 ( const __m128i a, const __m128i b )
+{
+	const __m128i even = _mm_mul_epu32 ( a, b );
+	const __m128i odd = _mm_mul_epu32 ( _mm_srli_si128 ( a, 4 ), _mm_srli_si128 ( b, 4 ) );
+	return _mm_unpacklo_epi32 ( _mm_shuffle_epi32 ( even, _MM_SHUFFLE ( 0, 0, 2, 0 ) ),
+								_mm_shuffle_epi32 ( odd, _MM_SHUFFLE ( 0, 0, 2, 0 ) ) );
+}
+
+// imulFix for four lanes
+static inline __m128i imulFix_sse2 ( const __m128i x, const __m128i y )
+{
+	return _mm_srai_epi32 ( mullo_epi32_sse2 ( x, y ), FIX_POINT_PRE );
+}
+
+// fog + ( c - fog ) * f, truncated like the scalar path
+static inline __m128i fog_sse2 ( const __m128i c, const __m128 fog, const __m128 f )
+{
+	return _mm_cvttps_epi32 ( _mm_add_ps ( fog, _mm_mul_ps ( _mm_sub_ps ( _mm_cvtepi32_ps ( c ), fog ), f ) ) );
+}
+
+#endif
+
 
 
 /*!
@@ -207,7 +270,105 @@ void CTRTextureGouraud2::scanline_bilinear ()
 	u32 dIndex = ( line.y & 3 ) << 2;
 #endif
 
-	for ( s32 i = 0; i <= dx; ++i )
+	s32 i = 0;
+
+#ifdef BURNING_SPAN_SSE2
+	// Interpolants are stepped per pixel exactly like the scalar loop and
+	// gathered into lanes, so both paths write the same pixels. Depth test,
+	// perspective divide, fixpoint conversion, modulation, fog and packing run
+	// four wide; only the texel fetch stays scalar per visible lane.
+	if ( dx >= 3 )
+	{
+		f32 lw[4];
+		f32 ltx[4], lty[4];
+		f32 lr[4], lg[4], lb[4];
+		s32 ttx[4], tty[4];
+		s32 sr[4], sg[4], sb[4];
+
+		const __m128 fixMul = _mm_set1_ps ( FIX_POINT_F32_MUL );
+		const __m128 fixInv = _mm_set1_ps ( 1.f / FIX_POINT_F32_MUL );
+		const __m128 fogEnd = _mm_set1_ps ( FogEnd );
+		const __m128 fogScale = _mm_set1_ps ( FogScale );
+		const __m128 fogR = _mm_set1_ps ( FogColor[0] );
+		const __m128 fogG = _mm_set1_ps ( FogColor[1] );
+		const __m128 fogB = _mm_set1_ps ( FogColor[2] );
+		const __m128 zero = _mm_setzero_ps ();
+		const __m128 one = _mm_set1_ps ( 1.f );
+		const __m128i colorMax = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+		const __m128i alpha = _mm_set1_epi32 ( ( FIXPOINT_COLOR_MAX & FIXPOINT_COLOR_MAX ) << ( SHIFT_A - FIX_POINT_PRE ) );
+
+		for ( ; i + 3 <= dx; i += 4 )
+		{
+			for ( s32 k = 0; k < 4; ++k )
+			{
+				lw[k] = line.w[0];
+				ltx[k] = line.t[0][0].x;
+				lty[k] = line.t[0][0].y;
+				lr[k] = line.c[0][0].y;
+				lg[k] = line.c[0][0].z;
+				lb[k] = line.c[0][0].w;
+
+				line.w[0] += slopeW;
+				line.c[0][0] += slopeC;
+				line.t[0][0] += slopeT[0];
+			}
+
+			const __m128 w = _mm_loadu_ps ( lw );
+			const __m128 zOld = _mm_loadu_ps ( z + i );
+			const __m128 pass = _mm_cmpge_ps ( w, zOld );
+			const s32 mask = _mm_movemask_ps ( pass );
+			if ( 0 == mask )
+				continue;
+
+			_mm_storeu_ps ( z + i, _mm_or_ps ( _mm_and_ps ( pass, w ), _mm_andnot_ps ( pass, zOld ) ) );
+
+			const __m128 inversew = _mm_div_ps ( fixMul, w );
+			_mm_storeu_si128 ( (__m128i*) ttx, _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( ltx ), inversew ) ) );
+			_mm_storeu_si128 ( (__m128i*) tty, _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( lty ), inversew ) ) );
+
+			for ( s32 k = 0; k < 4; ++k )
+			{
+				if ( mask & ( 1 << k ) )
+					getSample_texture ( sr[k], sg[k], sb[k], &IT[0], ttx[k], tty[k] );
+				else
+					sr[k] = sg[k] = sb[k] = 0;
+			}
+
+			__m128i r = imulFix_sse2 ( _mm_loadu_si128 ( (__m128i*) sr ), _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( lr ), inversew ) ) );
+			__m128i g = imulFix_sse2 ( _mm_loadu_si128 ( (__m128i*) sg ), _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( lg ), inversew ) ) );
+			__m128i b = imulFix_sse2 ( _mm_loadu_si128 ( (__m128i*) sb ), _mm_cvttps_epi32 ( _mm_mul_ps ( _mm_loadu_ps ( lb ), inversew ) ) );
+
+			if ( Fog )
+			{
+				const __m128 depth = _mm_mul_ps ( inversew, fixInv );
+				const __m128 f = _mm_min_ps ( _mm_max_ps ( _mm_mul_ps ( _mm_sub_ps ( fogEnd, depth ), fogScale ), zero ), one );
+				r = fog_sse2 ( r, fogR, f );
+				g = fog_sse2 ( g, fogG, f );
+				b = fog_sse2 ( b, fogB, f );
+			}
+
+			// fix_to_color
+			r = _mm_slli_epi32 ( _mm_and_si128 ( r, colorMax ), SHIFT_R - FIX_POINT_PRE );
+			g = _mm_srli_epi32 ( _mm_and_si128 ( g, colorMax ), FIX_POINT_PRE - SHIFT_G );
+			b = _mm_srli_epi32 ( _mm_and_si128 ( b, colorMax ), FIX_POINT_PRE - SHIFT_B );
+			const __m128i color = _mm_or_si128 ( _mm_or_si128 ( alpha, r ), _mm_or_si128 ( g, b ) );
+
+			if ( 0xF == mask )
+			{
+				_mm_storeu_si128 ( (__m128i*) ( dst + i ), color );
+			}
+			else
+			{
+				const __m128i keep = _mm_castps_si128 ( pass );
+				const __m128i old = _mm_loadu_si128 ( (__m128i*) ( dst + i ) );
+				_mm_storeu_si128 ( (__m128i*) ( dst + i ),
+					_mm_or_si128 ( _mm_and_si128 ( keep, color ), _mm_andnot_si128 ( keep, old ) ) );
+			}
+		}
+	}
+#endif
+
+	for ( ; i <= dx; ++i )
 	{
 #ifdef CMP_Z
 		if ( line.z[0] < z[i] )
@@ -246,10 +407,21 @@ void CTRTextureGouraud2::scanline_bilinear ()
 #ifdef IPOL_C0
 			getSample_texture ( r0, g0, b0, &IT[0], tx0,ty0 );
 
-			dst[i] = fix_to_color ( imulFix ( r0, r1 ),
-									imulFix ( g0, g1 ),
-									imulFix ( b0, b1 )
-								);
+			r0 = imulFix ( r0, r1 );
+			g0 = imulFix ( g0, g1 );
+			b0 = imulFix ( b0, b1 );
+
+#ifdef INVERSE_W
+			if ( Fog )
+			{
+				const f32 f = core::clamp ( ( FogEnd - inversew * ( 1.f / FIX_POINT_F32_MUL ) ) * FogScale, 0.f, 1.f );
+				r0 = (tFixPoint) ( FogColor[0] + ( (f32) r0 - FogColor[0] ) * f );
+				g0 = (tFixPoint) ( FogColor[1] + ( (f32) g0 - FogColor[1] ) * f );
+				b0 = (tFixPoint) ( FogColor[2] + ( (f32) b0 - FogColor[2] ) * f );
+			}
+#endif
+
+			dst[i] = fix_to_color ( r0, g0, b0 );
 #else
 
 #ifdef BURNINGVIDEO_RENDERER_FAST
@@ -93,6 +93,13 @@
 
 #define SOFTWARE_DRIVER_2_MIPMAPPING_SCALE (8/SOFTWARE_DRIVER_2_MIPMAPPING_MAX)
 
+// SSE2 span kernels: on for x86-64 and x86 with SSE2 enabled, 32 bit color
+// only. Define _IRR_BURNING_NO_SIMD_ to build the scalar span loops.
+#if !defined(_IRR_BURNING_NO_SIMD_) && defined ( SOFTWARE_DRIVER_2_32BIT ) && !defined(__BIG_ENDIAN__) && \
+	( defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) )
+	#define SOFTWARE_DRIVER_2_SSE2
+#endif
+
 #ifndef REALINLINE
 	#ifdef _MSC_VER
 		#define REALINLINE __forceinline
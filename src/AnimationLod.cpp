@@ -0,0 +1,66 @@
+#include "AnimationLod.h"
+#include <cmath>
+
+AnimationLod::AnimationLod(f32 reducedInterval)
+	: m_reducedInterval(reducedInterval)
+	, m_counts{0, 0, 0}
+{
+}
+
+void AnimationLod::beginFrame()
+{
+	for (u32 i = 0; i < LEVEL_COUNT; i++)
+		m_counts[i] = 0;
+}
+
+void AnimationLod::update(IAnimatedMeshSceneNode* node, State& state, Level level, f32 deltaTime)
+{
+	// A non-zero speed was set by the actor (setMD2Animation on a state
+	// change) or is still the full rate; either way it is the one to keep
+	const f32 speed = node->getAnimationSpeed();
+	if (speed != 0.0f)
+	{
+		// Time skipped in the old loop doesn't carry over into a new one
+		if (state.level != FULL)
+			state.pending = 0.0f;
+		state.fps = speed;
+	}
+
+	state.level = level;
+	m_counts[level]++;
+
+	if (level == FULL)
+	{
+		if (state.pending > 0.0f)
+		{
+			advance(node, state.pending * state.fps);
+			state.pending = 0.0f;
+		}
+		node->setAnimationSpeed(state.fps);
+		return;
+	}
+
+	// The node itself no longer advances; time is applied here in steps
+	node->setAnimationSpeed(0.0f);
+	state.pending += deltaTime;
+	if (level == REDUCED && state.pending >= m_reducedInterval)
+	{
+		advance(node, state.pending * state.fps);
+		state.pending = 0.0f;
+	}
+}
+
+void AnimationLod::advance(IAnimatedMeshSceneNode* node, f32 frames)
+{
+	const f32 start = (f32)node->getStartFrame();
+	const f32 end = (f32)node->getEndFrame();
+	f32 frame = node->getFrameNr() + frames;
+
+	// Same wrapping as CAnimatedMeshSceneNode::buildFrameNr
+	if (node->getLoopMode() && end > start)
+		frame = start + fmodf(frame - start, end - start);
+	else if (frame > end)
+		frame = end;
+
+	node->setCurrentFrame(frame);
+}
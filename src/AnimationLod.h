@@ -0,0 +1,41 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+// Update-rate LOD for animated MD2 nodes. Irrlicht advances every animated
+// node by the full frame time on each drawAll(), whether it is on screen or
+// not. Nodes at REDUCED are stepped by hand a few times per second and nodes
+// at FROZEN (outside the view frustum) not at all; the skipped time is kept
+// and applied when the node is stepped again, so loops stay in phase.
+// The caller picks the level; keep FULL for anything whose animation has to
+// be seen in full, like a death.
+class AnimationLod
+{
+public:
+	enum Level { FULL, REDUCED, FROZEN, LEVEL_COUNT };
+
+	// Per-node bookkeeping, owned by the actor
+	struct State
+	{
+		f32 fps = 0.0f;      // speed the node should animate at
+		f32 pending = 0.0f;  // seconds of animation not applied yet
+		Level level = FULL;
+	};
+
+	AnimationLod(f32 reducedInterval);
+
+	void beginFrame();
+	void update(IAnimatedMeshSceneNode* node, State& state, Level level, f32 deltaTime);
+
+	u32 getCount(Level level) const { return m_counts[level]; }
+	f32 getReducedInterval() const { return m_reducedInterval; }
+
+private:
+	static void advance(IAnimatedMeshSceneNode* node, f32 frames);
+
+	f32 m_reducedInterval;
+	u32 m_counts[LEVEL_COUNT];
+};
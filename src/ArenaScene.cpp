@@ -0,0 +1,284 @@
+#include "ArenaScene.h"
+#include <iostream>
+
+static const char* MAP_LOD_PATH = "assets/maps/colloseum/map_lods.bin";
+static const u32 MAP_CHUNK_GRID = 8; // map is split into 8x8 chunks for culling
+
+// Slack around a gate's bounds when testing its opening against the frustum
+static const f32 GATE_PORTAL_MARGIN = 50.0f;
+
+static const f32 SHADOW_GROUND_Y = -24.0f;
+
+ArenaScene::ArenaScene()
+	: m_smgr(nullptr)
+	, m_driver(nullptr)
+	, m_ground(nullptr)
+	, m_skyBox(nullptr)
+	, m_mapNode(nullptr)
+	, m_staticBatchNode(nullptr)
+	, m_staticBody(nullptr)
+	, m_blobShadows(nullptr)
+	, m_impostors(nullptr)
+	, m_impostorSkins{-1, -1, -1}
+	, m_fog(nullptr)
+{
+}
+
+ArenaScene::~ArenaScene()
+{
+	delete m_fog;
+}
+
+void ArenaScene::build(ISceneManager* smgr, ICameraSceneNode* camera, f32 farValue, Physics* physics)
+{
+	m_smgr = smgr;
+	m_driver = smgr->getVideoDriver();
+
+	// Owns the driver fog and the far plane from here on
+	m_fog = new FogManager(m_driver, camera, farValue);
+
+	m_ground = m_smgr->addCubeSceneNode(10.0f);
+	if (m_ground)
+	{
+		m_ground->setScale(vector3df(300.0f, 0.1f, 300.0f));
+		m_ground->setPosition(vector3df(0, -25, 0));
+		m_ground->setMaterialFlag(EMF_LIGHTING, false);
+		m_ground->setMaterialFlag(EMF_FOG_ENABLE, true);
+		m_ground->setMaterialTexture(0, m_driver->getTexture("assets/textures/building/ground.jpg"));
+	}
+
+	m_skyBox = m_smgr->addSkyBoxSceneNode(
+		m_driver->getTexture("assets/textures/skybox/irrlicht2_up.jpg"),
+		m_driver->getTexture("assets/textures/skybox/irrlicht2_dn.jpg"),
+		m_driver->getTexture("assets/textures/skybox/irrlicht2_lf.jpg"),
+		m_driver->getTexture("assets/textures/skybox/irrlicht2_rt.jpg"),
+		m_driver->getTexture("assets/textures/skybox/irrlicht2_ft.jpg"),
+		m_driver->getTexture("assets/textures/skybox/irrlicht2_bk.jpg"));
+
+	// Static collision: ground and walls here, obstacles in addObstacles()
+	m_staticCollision.addBox(vector3df(ARENA_HALF_SIZE, 0.5f, ARENA_HALF_SIZE), vector3df(0, -25, 0));
+
+	// Arena boundary walls 
+	float wallHeight = 200.0f;
+	float wallThickness = 80.0f;
+	float halfGround = ARENA_HALF_SIZE;
+	float wallY = -25.0f + wallHeight / 2.0f;
+
+	// +X wall at x=1500
+	m_staticCollision.addBox(vector3df(wallThickness / 2.0f, wallHeight / 2.0f, halfGround), vector3df(halfGround - 300, wallY, 0));
+	// -X wall at x=-1500
+	m_staticCollision.addBox(vector3df(wallThickness / 2.0f, wallHeight / 2.0f, halfGround), vector3df(-halfGround + 50, wallY, 0));
+	// +Z wall at z=1500
+	m_staticCollision.addBox(vector3df(halfGround, wallHeight / 2.0f, wallThickness / 2.0f), vector3df(0, wallY, halfGround - 300));
+	// -Z wall at z=-1500
+	m_staticCollision.addBox(vector3df(halfGround, wallHeight / 2.0f, wallThickness / 2.0f), vector3df(0, wallY, -halfGround + 320));
+
+	// side wall of +X wall (rotated 45 degrees)
+	m_staticCollision.addBox(vector3df(wallThickness / 2.0f, wallHeight / 2.0f, halfGround), vector3df(halfGround - 300, wallY, -270), 45.0f);
+
+	// side wall of +X wall (rotated 45 degrees)
+	m_staticCollision.addBox(vector3df(wallThickness / 2.0f, wallHeight / 2.0f, halfGround + 200), vector3df(halfGround - 50, wallY, 100.0f), -47.0f);
+
+	m_blobShadows = new BlobShadowRenderer(SHADOW_GROUND_Y, m_smgr->getRootSceneNode(), m_smgr);
+	m_blobShadows->drop();
+
+	m_smgr->addLightSceneNode(0, vector3df(0, 500, 0), SColorf(1.0f, 1.0f, 1.0f), 1500.0f);
+	m_smgr->setAmbientLight(SColorf(0.3f, 0.3f, 0.3f));
+	m_smgr->setShadowColor(video::SColor(150, 0, 0, 0));
+
+	addMap();
+	addGates();
+	addObstacles();
+
+	if (physics)
+		m_staticBody = m_staticCollision.build(physics);
+
+	// Obstacles and gates never move: render them from merged world-space buffers
+	m_staticBatchNode = m_staticBatch.build(m_smgr);
+	std::cout << "Static batching: " << m_staticBatch.getDrawCallsBefore() << " draw calls -> "
+		<< m_staticBatch.getDrawCallsAfter() << std::endl;
+	const MeshOptimizer::Stats& batchStats = m_staticBatch.getOptimizeStats();
+	std::cout << "Static batch mesh: " << batchStats.verticesBefore << " -> " << batchStats.verticesAfter
+		<< " vertices, ACMR " << batchStats.acmrBefore << " -> " << batchStats.acmrAfter << std::endl;
+}
+
+void ArenaScene::addMap()
+{
+	// The map is chunked so only the slice of the ring in view is submitted.
+	// Cache ordering happens first; chunks keep the triangle order.
+	IAnimatedMesh* mapMesh = m_smgr->getMesh("assets/maps/colloseum/Colloseum.obj");
+	MeshOptimizer::Stats mapStats;
+	SMesh* mapOptimized = MeshOptimizer::optimize(mapMesh ? mapMesh->getMesh(0) : nullptr, &mapStats);
+	std::cout << "Map mesh: " << mapStats.verticesBefore << " -> " << mapStats.verticesAfter
+		<< " vertices, ACMR " << mapStats.acmrBefore << " -> " << mapStats.acmrAfter << std::endl;
+	m_mapNode = new ChunkedMeshSceneNode(mapOptimized, MAP_CHUNK_GRID,
+		m_smgr->getRootSceneNode(), m_smgr);
+	m_mapNode->drop();
+	mapOptimized->drop();
+
+	// Lower detail levels per chunk: load the bake, or decimate and bake it
+	if (!m_mapNode->loadLods(MAP_LOD_PATH))
+	{
+		m_mapNode->buildLods();
+		if (m_mapNode->saveLods(MAP_LOD_PATH))
+			std::cout << "Baked map LODs to " << MAP_LOD_PATH << std::endl;
+	}
+	for (u32 l = 0; l < m_mapNode->getLodCount(); l++)
+		std::cout << "Map LOD " << l << ": " << m_mapNode->getLodTriangles(l) << " triangles, error up to "
+			<< m_mapNode->getLodError(l) << " model units" << std::endl;
+	ChunkedMeshSceneNode* map = m_mapNode;
+	map->setPosition(vector3df(-620, 180, 0));
+
+	map->setScale(vector3df(10, 11, 11));
+	map->setMaterialFlag(EMF_LIGHTING, false);
+	map->setMaterialFlag(EMF_FOG_ENABLE, true);
+}
+
+void ArenaScene::addGates()
+{
+	ISceneNode* map = m_mapNode;
+	IMesh* gateMesh = m_smgr->getMesh("assets/maps/gate/gate.obj");
+	ITexture* pillarTex = m_driver->getTexture("assets/textures/obstacles/pillar.png");
+
+	struct GateData { vector3df position; f32 rotationY; };
+	GateData gates[] =
+	{
+		{ vector3df( -7, -25,  -5),  90.0f },  // +X edge, face inward
+		{ vector3df( 105, -25,  5), -90.0f },  // -X edge, face inward
+		{ vector3df(    0, -25, 38), 180.0f },  // +Z edge, face inward
+		{ vector3df(    0, -25,-38),   0.0f },  // -Z edge, face inward
+	};
+
+	for (const auto& g : gates)
+	{
+		IMeshSceneNode* gate = m_smgr->addMeshSceneNode(gateMesh, map);
+		gate->setPosition(g.position);
+		gate->setRotation(vector3df(0, g.rotationY, 0));
+		gate->setScale(vector3df(4, 3, 8));
+		gate->setMaterialFlag(video::EMF_LIGHTING, false);
+		gate->setMaterialFlag(video::EMF_FOG_ENABLE, true);
+
+		IMeshSceneNode* blackCube = m_smgr->addCubeSceneNode(20.0f, gate);
+		blackCube->setPosition(vector3df(2, 5.6f, -10.3f));
+		blackCube->setScale(vector3df(0.3f, 0.35f, 0.1f));
+		blackCube->setMaterialFlag(video::EMF_LIGHTING, true);
+		blackCube->setMaterialFlag(video::EMF_FOG_ENABLE, true);
+		blackCube->setMaterialType(video::EMT_SOLID);
+		blackCube->getMaterial(0).ColorMaterial = video::ECM_NONE;
+		blackCube->getMaterial(0).DiffuseColor = SColor(255, 0, 0, 0);
+		blackCube->getMaterial(0).AmbientColor = SColor(255, 0, 0, 0);
+		blackCube->getMaterial(0).EmissiveColor = SColor(255, 0, 0, 0);
+
+		IMeshSceneNode* leftCube = m_smgr->addCubeSceneNode(20.0f, gate);
+		leftCube->setPosition(vector3df(-2, 5.6f, -9.8f));
+		leftCube->setScale(vector3df(0.06f, 0.35f, 0.1f));
+		leftCube->setMaterialFlag(video::EMF_LIGHTING, false);
+		leftCube->setMaterialFlag(video::EMF_FOG_ENABLE, true);
+		leftCube->setMaterialTexture(0, pillarTex);
+
+		IMeshSceneNode* rightCube = m_smgr->addCubeSceneNode(20.0f, gate);
+		rightCube->setPosition(vector3df(5.5f, 5.6f, -9.8f));
+		rightCube->setScale(vector3df(0.06f, 0.35f, 0.1f));
+		rightCube->setMaterialFlag(video::EMF_LIGHTING, false);
+		rightCube->setMaterialFlag(video::EMF_FOG_ENABLE, true);
+		rightCube->setMaterialTexture(0, pillarTex);
+
+		vector3df mapPos = map->getPosition();
+		vector3df mapScale = map->getScale();
+		vector3df worldPos(
+			mapPos.X + g.position.X * mapScale.X,
+			0.0f,  
+			mapPos.Z + g.position.Z * mapScale.Z
+		);
+		m_gatePositions.push_back(worldPos);
+
+		// The gate's bounds are the only view into its spawn tunnel; taken
+		// before the node is baked into the static batch and removed
+		map->updateAbsolutePosition();
+		gate->updateAbsolutePosition();
+		aabbox3df opening = gate->getTransformedBoundingBox();
+		opening.MinEdge -= vector3df(GATE_PORTAL_MARGIN);
+		opening.MaxEdge += vector3df(GATE_PORTAL_MARGIN);
+		m_gatePortals.add(opening, vector3df(-worldPos.X, 0.0f, -worldPos.Z));
+
+		m_staticBatch.add(gate);
+	}
+}
+
+void ArenaScene::addObstacles()
+{
+	struct ObstacleData { float x, z, w, h, d; bool isPillar; };
+	static const ObstacleData obstacles[] =
+	{
+		// Pillars 
+		{  150,  250, 50, 180, 50, true },
+		{ -300,  400, 60, 210, 60, true },
+		{  500, -200, 40, 150, 40, true },
+		{ -600, -500, 70, 240, 70, true },
+		{  800,  600, 50, 165, 50, true },
+		{ -900,  100, 60, 195, 60, true },
+		{  350, -700, 40, 225, 40, true },
+		{ -200, -900, 50, 180, 50, true },
+		{ 1000, -400, 60, 210, 60, true },
+		{-1100,  700, 50, 150, 50, true },
+		{  700,  900, 70, 240, 70, true },
+		{ -500,  800, 40, 165, 40, true },
+
+		// Boxes 
+		{  250, -350, 50, 30, 40, false },
+		{ -400, -150, 60, 40, 50, false },
+		{  600,  350, 40, 25, 35, false },
+		{ -750,  500, 55, 45, 45, false },
+		{  450,  700, 45, 30, 55, false },
+		{ -300, -600, 50, 40, 40, false },
+		{  900, -100, 35, 25, 60, false },
+		{-1000, -300, 60, 45, 50, false },
+		{  200,  500, 40, 30, 40, false },
+		{ -150,  150, 55, 40, 55, false },
+		{  750, -800, 45, 25, 35, false },
+		{ -800, -700, 50, 45, 45, false },
+	};
+
+	static const float groundY = -25.0f;
+	ITexture* pillarTex = m_driver->getTexture("assets/textures/obstacles/pillar.png");
+	ITexture* boxTex = m_driver->getTexture("assets/textures/obstacles/box.jpg");
+
+	for (const auto& obs : obstacles)
+	{
+		scene::ISceneNode* node = m_smgr->addCubeSceneNode(1.0f);
+		if (node)
+		{
+			node->setScale(core::vector3df(obs.w, obs.h, obs.d));
+
+			core::vector3df pos(obs.x, groundY + obs.h / 2.0f, obs.z);
+			node->setPosition(pos);
+			node->setMaterialFlag(video::EMF_LIGHTING, false);
+			node->setMaterialFlag(video::EMF_FOG_ENABLE, true);
+			node->setMaterialTexture(0, obs.isPillar ? pillarTex : boxTex);
+
+			m_staticCollision.addBox(vector3df(obs.w * 0.5f, obs.h * 0.5f, obs.d * 0.5f), pos);
+
+			m_staticBatch.add(node);
+		}
+	}
+}
+
+void ArenaScene::setupImpostors()
+{
+	m_impostors = new ImpostorRenderer(m_smgr->getRootSceneNode(), m_smgr);
+	m_impostors->drop();
+	if (!m_impostors->isAvailable())
+	{
+		std::cout << "Impostors: no render target support, distant enemies stay full meshes" << std::endl;
+		return;
+	}
+
+	// The atlas is rendered once through the driver, which needs an open scene
+	IAnimatedMesh* enemyMesh = m_smgr->getMesh("assets/models/enemy/tris.md2");
+	m_driver->beginScene(true, true, SColor(255, 0, 0, 0));
+	m_impostorSkins[SKIN_BASIC] = m_impostors->addSkin(enemyMesh, m_driver->getTexture("assets/models/enemy/ctf_b.pcx"));
+	m_impostorSkins[SKIN_FAST] = m_impostors->addSkin(enemyMesh, m_driver->getTexture("assets/models/enemy/ctf_r.pcx"));
+	m_impostorSkins[SKIN_FOG_ENEMY] = m_impostors->addSkin(m_smgr->getMesh("assets/models/fog_enemy/Tris.md2"),
+		m_driver->getTexture("assets/models/fog_enemy/Default.pcx"));
+	m_driver->endScene();
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <irrlicht.h>
+#include <vector>
+#include "Physics.h"
+#include "StaticCollision.h"
+#include "ChunkedMeshSceneNode.h"
+#include "StaticBatch.h"
+#include "BlobShadowRenderer.h"
+#include "ImpostorRenderer.h"
+#include "FogManager.h"
+#include "GatePortals.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Half extent of the arena ground; the bounded broadphases are sized from it
+static const f32 ARENA_HALF_SIZE = 1500.0f;
+static const f32 CAMERA_FAR_VALUE = 20000.0f;
+static const f32 ENEMY_SHADOW_RADIUS = 20.0f; // scaled by the enemy's node scale
+
+// Everything in the arena that isn't an actor: sky, ground, the chunked
+// Colosseum with its LODs, obstacles and gates merged into the static batch,
+// the light, and the shared renderers actors are drawn through (blob
+// shadows, impostors, and the fog manager with its cloud particles). The
+// game and --bench-render both build it from here, so the benchmark draws
+// the same scene players see.
+class ArenaScene
+{
+public:
+	// Impostor skins, see getImpostorSkin()
+	enum ImpostorSkin { SKIN_BASIC, SKIN_FAST, SKIN_FOG_ENEMY, SKIN_COUNT };
+
+	ArenaScene();
+	~ArenaScene();
+
+	// Adds the scene to smgr. The fog manager drives camera's far plane,
+	// farValue while there is no dense fog. With physics, the ground, walls
+	// and obstacles also become one static compound body.
+	void build(ISceneManager* smgr, ICameraSceneNode* camera, f32 farValue, Physics* physics);
+
+	// Renders the enemy skins into the impostor atlas; must be called
+	// outside the driver's beginScene()/endScene()
+	void setupImpostors();
+
+	ChunkedMeshSceneNode* getMap() const { return m_mapNode; }
+	const StaticBatch& getStaticBatch() const { return m_staticBatch; }
+	BlobShadowRenderer* getBlobShadows() const { return m_blobShadows; }
+	// Null if the driver has no render target support
+	ImpostorRenderer* getImpostors() const { return m_impostors; }
+	s32 getImpostorSkin(ImpostorSkin skin) const { return m_impostorSkins[skin]; }
+	FogManager* getFog() const { return m_fog; }
+	GatePortals& getGatePortals() { return m_gatePortals; }
+	const std::vector<vector3df>& getGatePositions() const { return m_gatePositions; }
+
+private:
+	void addMap();
+	void addGates();
+	void addObstacles();
+
+	ISceneManager*        m_smgr;
+	IVideoDriver*         m_driver;
+	ISceneNode*           m_ground;
+	ISceneNode*           m_skyBox;
+	ChunkedMeshSceneNode* m_mapNode;
+	StaticBatch           m_staticBatch;     // obstacles and gate dressing
+	IMeshSceneNode*       m_staticBatchNode;
+	StaticCollision       m_staticCollision;
+	btRigidBody*          m_staticBody;
+	BlobShadowRenderer*   m_blobShadows;
+	ImpostorRenderer*     m_impostors;
+	s32                   m_impostorSkins[SKIN_COUNT];
+	FogManager*           m_fog;
+
+	// Gate spawn positions (for enemy spawning)
+	std::vector<vector3df> m_gatePositions;
+	GatePortals m_gatePortals; // visibility into the spawn tunnels
+};
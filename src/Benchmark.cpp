@@ -0,0 +1,610 @@
+#include "Benchmark.h"
+#include "ArenaScene.h"
+#include "Physics.h"
+#include "StaticCollision.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const f32 BENCH_TIME_STEP = 1.0f / 60.0f;
+static const int BENCH_WARMUP_STEPS = 60;
+static const int BENCH_MEASURED_STEPS = 300;
+static const f32 BENCH_ENEMY_SPEED = 160.0f;
+static const int BENCH_RAYS = 1000;
+static const f32 BENCH_ARENA_HALF_SIZE = 1500.0f;
+static const int BENCH_MD2_PASSES = 200;
+static const u32 BENCH_RASTER_WIDTH = 800;
+static const u32 BENCH_RASTER_HEIGHT = 450;
+static const int BENCH_RASTER_FRAMES = 120;
+static const f32 BENCH_RASTER_ORBIT = 600.0f;
+static const u32 BENCH_RENDER_WIDTH = 640;
+static const u32 BENCH_RENDER_HEIGHT = 360;
+static const int BENCH_RENDER_FRAMES = 240;
+static const int BENCH_GOLDEN_INTERVAL = 60;      // every 60th frame is compared
+static const u32 BENCH_GOLDEN_TOLERANCE = 12;     // per channel, out of 255
+static const f32 BENCH_GOLDEN_MAX_OFF = 0.005f;   // share of pixels allowed past it
+static const char* BENCH_GOLDEN_DIR = "bench/golden";
+static const char* BENCH_RENDER_CSV = "bench_render.csv";
+static const u32 BENCH_RENDER_SEED = 1234;        // fog cloud particles
+static const f32 BENCH_IMPOSTOR_DISTANCE = 900.0f;
+
+typedef std::chrono::high_resolution_clock BenchClock;
+
+static f64 elapsedMs(BenchClock::time_point start)
+{
+	return std::chrono::duration<f64, std::milli>(BenchClock::now() - start).count();
+}
+
+// Ground and the four boundary walls from Game::setupScene
+static void addArena(StaticCollision& arena)
+{
+	arena.addBox(vector3df(1500.0f, 0.5f, 1500.0f), vector3df(0, -25, 0));
+	arena.addBox(vector3df(40.0f, 100.0f, 1500.0f), vector3df(1200.0f, 75.0f, 0));
+	arena.addBox(vector3df(40.0f, 100.0f, 1500.0f), vector3df(-1450.0f, 75.0f, 0));
+	arena.addBox(vector3df(1500.0f, 100.0f, 40.0f), vector3df(0, 75.0f, 1200.0f));
+	arena.addBox(vector3df(1500.0f, 100.0f, 40.0f), vector3df(0, 75.0f, -1180.0f));
+}
+
+// Capsules shaped like Enemy::createPhysicsBody, spread on rings around the player
+static void spawnSwarm(Physics& physics, int count, std::vector<btRigidBody*>& bodies)
+{
+	for (int i = 0; i < count; i++)
+	{
+		f32 angle = i * 2.39996f; // golden angle keeps the rings evenly filled
+		f32 radius = 150.0f + (i % 20) * 50.0f;
+		vector3df pos(cosf(angle) * radius, 0.0f, sinf(angle) * radius);
+
+		btRigidBody* body = physics.createRigidBody(10.0f, new btCapsuleShape(15.0f, 30.0f), pos);
+		body->setAngularFactor(btVector3(0, 0, 0));
+		body->setActivationState(DISABLE_DEACTIVATION);
+		bodies.push_back(body);
+	}
+}
+
+// Same per-tick work as Enemy::updateAI in CHASE: steer towards the player
+static void chase(const std::vector<btRigidBody*>& bodies)
+{
+	for (btRigidBody* body : bodies)
+	{
+		btVector3 dir = -body->getWorldTransform().getOrigin();
+		dir.setY(0);
+		if (dir.length2() > 1.0f)
+			dir.normalize();
+		body->setLinearVelocity(btVector3(dir.getX() * BENCH_ENEMY_SPEED,
+			body->getLinearVelocity().getY(), dir.getZ() * BENCH_ENEMY_SPEED));
+	}
+}
+
+int Benchmark::runPhysicsThreads()
+{
+	static const int threadCounts[] = { 1, 2, 4, 8 };
+	static const int enemyCounts[] = { 10, 50, 100, 200, 400, 800 };
+
+	printf("Physics step time (ms/step, %d steps at %.0f Hz)\n", BENCH_MEASURED_STEPS, 1.0f / BENCH_TIME_STEP);
+	printf("%8s", "enemies");
+	for (int threads : threadCounts)
+		printf("  %6d thr", threads);
+	printf("\n");
+
+	for (int enemies : enemyCounts)
+	{
+		printf("%8d", enemies);
+		for (int threads : threadCounts)
+		{
+			StaticCollision arena;
+			addArena(arena);
+
+			PhysicsConfig config;
+			config.numThreads = threads;
+			Physics physics(config);
+			arena.build(&physics);
+
+			std::vector<btRigidBody*> bodies;
+			spawnSwarm(physics, enemies, bodies);
+
+			for (int i = 0; i < BENCH_WARMUP_STEPS; i++)
+			{
+				chase(bodies);
+				physics.stepSimulation(BENCH_TIME_STEP, 1);
+			}
+
+			BenchClock::time_point start = BenchClock::now();
+			for (int i = 0; i < BENCH_MEASURED_STEPS; i++)
+			{
+				chase(bodies);
+				physics.stepSimulation(BENCH_TIME_STEP, 1);
+			}
+			f64 msPerStep = elapsedMs(start) / BENCH_MEASURED_STEPS;
+
+			for (btRigidBody* body : bodies)
+				physics.removeRigidBody(body);
+
+			if (physics.getNumThreads() != threads)
+				printf("  %6.3f(%d)", msPerStep, physics.getNumThreads());
+			else
+				printf("  %10.3f", msPerStep);
+		}
+		printf("\n");
+	}
+	return 0;
+}
+
+// Deterministic generator so every broadphase gets the same rays
+static f32 nextRandom(u32& state)
+{
+	state = state * 1664525u + 1013904223u;
+	return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+int Benchmark::runBroadphase()
+{
+	static const BroadphaseType types[] = {
+		BroadphaseType::DBVT, BroadphaseType::AXIS_SWEEP, BroadphaseType::AXIS_SWEEP_32, BroadphaseType::GRID
+	};
+	static const int enemyCounts[] = { 100, 200, 400, 800 };
+
+	printf("Broadphase cost (%d steps at %.0f Hz, %d rays per row)\n", BENCH_MEASURED_STEPS, 1.0f / BENCH_TIME_STEP, BENCH_RAYS);
+	printf("%-6s %8s %10s %12s %8s %10s\n", "type", "enemies", "step ms", "pair upd ms", "pairs", "ray us");
+
+	for (BroadphaseType type : types)
+	{
+		for (int enemies : enemyCounts)
+		{
+			StaticCollision arena;
+			addArena(arena);
+
+			PhysicsConfig config;
+			config.broadphase = type;
+			config.worldMin = vector3df(-BENCH_ARENA_HALF_SIZE - 200.0f, -200.0f, -BENCH_ARENA_HALF_SIZE - 200.0f);
+			config.worldMax = vector3df(BENCH_ARENA_HALF_SIZE + 200.0f, 800.0f, BENCH_ARENA_HALF_SIZE + 200.0f);
+			Physics physics(config);
+			arena.build(&physics);
+			btDiscreteDynamicsWorld* world = physics.getWorld();
+
+			std::vector<btRigidBody*> bodies;
+			spawnSwarm(physics, enemies, bodies);
+
+			for (int i = 0; i < BENCH_WARMUP_STEPS; i++)
+			{
+				chase(bodies);
+				physics.stepSimulation(BENCH_TIME_STEP, 1);
+			}
+
+			// Full steps, then the broadphase on its own: bodies are advanced one
+			// more tick along their velocity so the pair update sees real motion
+			f64 stepMs = 0.0, pairMs = 0.0;
+			int pairs = 0;
+			for (int i = 0; i < BENCH_MEASURED_STEPS; i++)
+			{
+				chase(bodies);
+				BenchClock::time_point start = BenchClock::now();
+				physics.stepSimulation(BENCH_TIME_STEP, 1);
+				stepMs += elapsedMs(start);
+
+				for (btRigidBody* body : bodies)
+				{
+					btTransform transform = body->getWorldTransform();
+					transform.setOrigin(transform.getOrigin() + body->getLinearVelocity() * BENCH_TIME_STEP);
+					body->setWorldTransform(transform);
+				}
+
+				start = BenchClock::now();
+				world->updateAabbs();
+				world->computeOverlappingPairs();
+				pairMs += elapsedMs(start);
+				pairs += world->getPairCache()->getNumOverlappingPairs();
+			}
+
+			u32 seed = 12345u;
+			BenchClock::time_point start = BenchClock::now();
+			for (int i = 0; i < BENCH_RAYS; i++)
+			{
+				f32 extent = 2.0f * BENCH_ARENA_HALF_SIZE;
+				vector3df from((nextRandom(seed) - 0.5f) * extent, 20.0f, (nextRandom(seed) - 0.5f) * extent);
+				vector3df to((nextRandom(seed) - 0.5f) * extent, 20.0f, (nextRandom(seed) - 0.5f) * extent);
+				physics.rayTest(from, to);
+			}
+			f64 rayUs = elapsedMs(start) * 1000.0 / BENCH_RAYS;
+
+			for (btRigidBody* body : bodies)
+				physics.removeRigidBody(body);
+
+			printf("%-6s %8d %10.3f %12.3f %8d %10.2f\n", getBroadphaseName(type), enemies,
+				stepMs / BENCH_MEASURED_STEPS, pairMs / BENCH_MEASURED_STEPS, pairs / BENCH_MEASURED_STEPS, rayUs);
+		}
+	}
+	return 0;
+}
+
+int Benchmark::runMD2Interpolation()
+{
+	static const char* meshes[] =
+	{
+		"assets/models/player/tris.md2",
+		"assets/models/enemy/tris.md2",
+		"assets/models/fog_enemy/Tris.md2",
+	};
+
+	// Null driver: only the mesh loader is needed. No pose cache is installed
+	// here, so every getMesh() call interpolates.
+	IrrlichtDevice* device = createDevice(video::EDT_NULL);
+	if (!device)
+		return 1;
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	printf("MD2 interpolation (%d passes over every frame)\n", BENCH_MD2_PASSES);
+	printf("%-36s %8s %8s %12s %12s\n", "mesh", "frames", "verts", "us/pose", "ns/vertex");
+
+	for (const char* path : meshes)
+	{
+		scene::IAnimatedMesh* mesh = smgr->getMesh(path);
+		if (!mesh)
+		{
+			printf("%-36s not found\n", path);
+			continue;
+		}
+
+		const s32 frameCount = (s32)mesh->getFrameCount();
+		const u32 vertexCount = mesh->getMesh(0)->getMeshBuffer(0)->getVertexCount();
+
+		BenchClock::time_point start = BenchClock::now();
+		for (int pass = 0; pass < BENCH_MD2_PASSES; pass++)
+			for (s32 frame = 0; frame < frameCount; frame++)
+				mesh->getMesh(frame, 255, 0, frameCount - 1);
+		f64 ms = elapsedMs(start);
+
+		f64 poses = (f64)BENCH_MD2_PASSES * frameCount;
+		printf("%-36s %8d %8u %12.2f %12.2f\n", path, frameCount, vertexCount,
+			ms * 1000.0 / poses, ms * 1000000.0 / (poses * vertexCount));
+	}
+
+	device->drop();
+	return 0;
+}
+
+// Burning's Video device. Falls back to the console device where no window
+// can be opened, so the software benchmarks also run on a headless Linux box.
+static IrrlichtDevice* createSoftwareDevice(u32 width, u32 height)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = dimension2d<u32>(width, height);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+	{
+		params.DeviceType = EIDT_CONSOLE;
+		device = createDeviceEx(params);
+	}
+	return device;
+}
+
+// The arena as the game builds it, minus the physics body; false if the
+// map mesh is missing, which would leave little to render
+static bool buildBenchArena(ArenaScene& arena, scene::ISceneManager* smgr, scene::ICameraSceneNode* camera)
+{
+	arena.build(smgr, camera, CAMERA_FAR_VALUE, nullptr);
+	if (arena.getMap()->getLodTriangles(0) == 0)
+	{
+		printf("arena map mesh not found\n");
+		return false;
+	}
+	return true;
+}
+
+int Benchmark::runSoftwareRaster()
+{
+	struct FogPass { const char* name; bool cloud; };
+	static const FogPass passes[] =
+	{
+		{ "clear",     false },
+		{ "fog cloud", true },
+	};
+	// A fog enemy's cloud at its densest, landed in the middle of the arena
+	static const FogManager::Source cloud = { 1, vector3df(0, -25, 0), 1.0f, 250.0f, 300.0f };
+
+	IrrlichtDevice* device = createSoftwareDevice(BENCH_RASTER_WIDTH, BENCH_RASTER_HEIGHT);
+	if (!device)
+		return 1;
+	const bool present = device->getType() != EIDT_CONSOLE; // no ASCII art frames
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode();
+	ArenaScene arena;
+	if (!buildBenchArena(arena, smgr, camera))
+	{
+		device->drop();
+		return 1;
+	}
+	FogManager* fog = arena.getFog();
+	srand(BENCH_RENDER_SEED);
+
+	// Burning's Video rasterizes inside drawAll(), so that is what is timed;
+	// presenting the frame to the window is left out. The driver name says
+	// whether the library was built with the SSE2 span kernels; rebuild
+	// Irrlicht with _IRR_BURNING_NO_SIMD_ for the scalar baseline.
+	printf("Software rasterizer: %ls, %ux%u, %d frames orbiting the arena\n", driver->getName(),
+		BENCH_RASTER_WIDTH, BENCH_RASTER_HEIGHT, BENCH_RASTER_FRAMES);
+	printf("%-10s %10s %8s\n", "pass", "ms/frame", "fps");
+
+	std::vector<FogManager::Source> sources;
+	for (const FogPass& pass : passes)
+	{
+		sources.clear();
+		if (pass.cloud)
+			sources.push_back(cloud);
+
+		f64 ms = 0.0;
+		for (int frame = 0; frame < BENCH_RASTER_FRAMES; frame++)
+		{
+			f32 angle = frame * 2.0f * PI / BENCH_RASTER_FRAMES;
+			camera->setPosition(vector3df(cosf(angle) * BENCH_RASTER_ORBIT, 30.0f, sinf(angle) * BENCH_RASTER_ORBIT));
+			camera->setTarget(vector3df(0, 0, 0));
+			fog->update(sources, BENCH_TIME_STEP);
+
+			driver->beginScene(true, true, fog->getClearColor());
+			BenchClock::time_point start = BenchClock::now();
+			smgr->drawAll();
+			ms += elapsedMs(start);
+			if (present)
+				driver->endScene();
+		}
+
+		printf("%-10s %10.2f %8.1f\n", pass.name, ms / BENCH_RASTER_FRAMES, 1000.0 * BENCH_RASTER_FRAMES / ms);
+	}
+
+	device->drop();
+	return 0;
+}
+
+// Frozen enemy for the render benchmark, textured and scaled like Enemy and
+// FogEnemy; the animation is held on one frame so every run draws the same pose
+static scene::IAnimatedMeshSceneNode* addBenchEnemy(scene::ISceneManager* smgr, video::IVideoDriver* driver,
+	const char* mesh, const char* texture, f32 scale, const vector3df& pos, f32 rotationY, s32 frame)
+{
+	scene::IAnimatedMesh* animMesh = smgr->getMesh(mesh);
+	if (!animMesh)
+		return nullptr;
+
+	scene::IAnimatedMeshSceneNode* node = smgr->addAnimatedMeshSceneNode(animMesh);
+	node->setMaterialTexture(0, driver->getTexture(texture));
+	node->setMaterialFlag(EMF_LIGHTING, false);
+	node->setMaterialFlag(EMF_FOG_ENABLE, true);
+	node->setScale(vector3df(scale, scale, scale));
+	node->setPosition(pos);
+	node->setRotation(vector3df(0, rotationY, 0));
+	node->setMD2Animation(scene::EMAT_RUN);
+	node->setAnimationSpeed(0.0f);
+	node->setCurrentFrame((f32)(node->getStartFrame() + frame));
+	return node;
+}
+
+// One lap around the arena floor that swings in and out and climbs towards
+// the stands on the far side, always looking across the middle
+static void placeBenchCamera(scene::ICameraSceneNode* camera, int frame)
+{
+	f32 angle = frame * 2.0f * PI / BENCH_RENDER_FRAMES;
+	f32 radius = 550.0f + 250.0f * sinf(angle * 2.0f);
+	f32 height = 40.0f + 80.0f * (1.0f - cosf(angle));
+	camera->setPosition(vector3df(cosf(angle) * radius, height, sinf(angle) * radius));
+	camera->setTarget(vector3df(-sinf(angle) * 150.0f, 0.0f, cosf(angle) * 150.0f));
+}
+
+// Share of pixels whose largest channel difference is above the tolerance
+static f32 compareImages(video::IImage* frame, video::IImage* golden, u32& maxDelta)
+{
+	const dimension2du size = frame->getDimension();
+	u32 off = 0;
+	maxDelta = 0;
+	for (u32 y = 0; y < size.Height; y++)
+	{
+		for (u32 x = 0; x < size.Width; x++)
+		{
+			SColor a = frame->getPixel(x, y);
+			SColor b = golden->getPixel(x, y);
+			u32 delta = (u32)core::max_(core::abs_((s32)a.getRed() - (s32)b.getRed()),
+				core::abs_((s32)a.getGreen() - (s32)b.getGreen()), core::abs_((s32)a.getBlue() - (s32)b.getBlue()));
+			maxDelta = core::max_(maxDelta, delta);
+			if (delta > BENCH_GOLDEN_TOLERANCE)
+				off++;
+		}
+	}
+	return (f32)off / (size.Width * size.Height);
+}
+
+int Benchmark::runRenderFrames(bool updateGolden)
+{
+	struct BenchEnemy { const char* mesh; const char* texture; ArenaScene::ImpostorSkin skin; f32 scale; vector3df pos; f32 rotationY; s32 frame; };
+	static const BenchEnemy enemies[] =
+	{
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_b.pcx", ArenaScene::SKIN_BASIC, 1.0f, vector3df( 200, 0,  100),   0.0f, 0 },
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_b.pcx", ArenaScene::SKIN_BASIC, 1.0f, vector3df(-250, 0,  150),  45.0f, 2 },
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_b.pcx", ArenaScene::SKIN_BASIC, 1.0f, vector3df(-100, 0, -300), 120.0f, 4 },
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_b.pcx", ArenaScene::SKIN_BASIC, 1.0f, vector3df( 350, 0, -200), 200.0f, 1 },
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_r.pcx", ArenaScene::SKIN_FAST,  1.2f, vector3df(  50, 0,  400), 270.0f, 3 },
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_r.pcx", ArenaScene::SKIN_FAST,  1.2f, vector3df(-400, 0, -100),  90.0f, 5 },
+		{ "assets/models/fog_enemy/Tris.md2", "assets/models/fog_enemy/Default.pcx", ArenaScene::SKIN_FOG_ENEMY, 1.7f, vector3df(0, 0, -50), 180.0f, 2 },
+		// Near the walls, so the lap sees them as impostors or behind the fog
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_b.pcx", ArenaScene::SKIN_BASIC, 1.0f, vector3df( 900, 0,  600), 210.0f, 1 },
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_r.pcx", ArenaScene::SKIN_FAST,  1.2f, vector3df(-1000, 0, 400), 300.0f, 3 },
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_b.pcx", ArenaScene::SKIN_BASIC, 1.0f, vector3df(-700, 0, -900),  60.0f, 4 },
+		{ "assets/models/enemy/tris.md2", "assets/models/enemy/ctf_r.pcx", ArenaScene::SKIN_FAST,  1.2f, vector3df(1000, 0, -700), 140.0f, 0 },
+	};
+
+	// The fog enemy's cloud part way through clearing, puffing where its
+	// grenade landed: the far side of the arena is fogged out and the far
+	// plane pulled in, as the game does while it is dense
+	static const FogManager::Source cloud = { 1, vector3df(0, -25, -120), 0.6f, 500.0f, 1600.0f };
+
+	IrrlichtDevice* device = createSoftwareDevice(BENCH_RENDER_WIDTH, BENCH_RENDER_HEIGHT);
+	if (!device)
+		return 1;
+	const bool present = device->getType() != EIDT_CONSOLE;
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode();
+	ArenaScene arena;
+	if (!buildBenchArena(arena, smgr, camera))
+	{
+		device->drop();
+		return 1;
+	}
+	arena.setupImpostors();
+	FogManager* fog = arena.getFog();
+	ImpostorRenderer* impostors = arena.getImpostors();
+
+	struct BenchActor { scene::IAnimatedMeshSceneNode* node; s32 skin; };
+	std::vector<BenchActor> actors;
+	for (const BenchEnemy& e : enemies)
+	{
+		scene::IAnimatedMeshSceneNode* node = addBenchEnemy(smgr, driver, e.mesh, e.texture, e.scale, e.pos, e.rotationY, e.frame);
+		if (!node)
+		{
+			printf("%s not found\n", e.mesh);
+			continue;
+		}
+		arena.getBlobShadows()->addCaster(node, ENEMY_SHADOW_RADIUS * e.scale);
+		actors.push_back({ node, arena.getImpostorSkin(e.skin) });
+	}
+
+	// The cloud's particles are random; seeded and stepped at a fixed rate,
+	// and already spread out when the lap starts
+	std::vector<FogManager::Source> sources(1, cloud);
+	srand(BENCH_RENDER_SEED);
+	for (int step = 0; step < BENCH_WARMUP_STEPS; step++)
+		fog->update(sources, BENCH_TIME_STEP);
+
+	// Counted by the driver in every draw call; a stock Irrlicht build lacks
+	// these attributes, so rebuild it from libs/irrlicht-1.8.5/source
+	const io::IAttributes& driverStats = driver->getDriverAttributes();
+	const s32 drawCallsAttribute = driverStats.findAttribute("DrawCalls");
+	const s32 primitivesAttribute = driverStats.findAttribute("PrimitivesDrawn");
+	const bool counted = drawCallsAttribute >= 0 && primitivesAttribute >= 0;
+
+	FILE* csv = fopen(BENCH_RENDER_CSV, "w");
+	if (csv)
+		fprintf(csv, "frame,ms,draw_calls,primitives,impostors\n");
+
+	printf("Render frames: %ls, %ux%u, %d frames, %u enemies, fog %.0f-%.0f\n", driver->getName(),
+		BENCH_RENDER_WIDTH, BENCH_RENDER_HEIGHT, BENCH_RENDER_FRAMES, (u32)actors.size(), cloud.start, cloud.end);
+
+	std::vector<f64> times;
+	u64 totalDraws = 0, totalPrimitives = 0, totalImpostors = 0;
+	int failed = 0;
+	for (int frame = 0; frame < BENCH_RENDER_FRAMES; frame++)
+	{
+		placeBenchCamera(camera, frame);
+		fog->update(sources, BENCH_TIME_STEP);
+
+		// Enemies past the fog are skipped and far ones drawn as impostors,
+		// as Game::updateActorLod decides it
+		if (impostors)
+			impostors->clear();
+		for (const BenchActor& a : actors)
+		{
+			f32 distSQ = a.node->getPosition().getDistanceFromSQ(camera->getPosition());
+			bool fogCulled = fog->cull(distSQ);
+			bool impostor = impostors && !fogCulled && a.skin >= 0 && distSQ > BENCH_IMPOSTOR_DISTANCE * BENCH_IMPOSTOR_DISTANCE;
+			a.node->setVisible(!fogCulled && !impostor);
+			if (impostor)
+				impostors->add(a.node, a.skin);
+		}
+
+		// Burning's Video rasterizes inside drawAll(); presenting is left out
+		driver->beginScene(true, true, fog->getClearColor());
+		BenchClock::time_point start = BenchClock::now();
+		smgr->drawAll();
+		f64 ms = elapsedMs(start);
+		times.push_back(ms);
+
+		u32 draws = counted ? (u32)driverStats.getAttributeAsInt(drawCallsAttribute) : 0;
+		u32 primitives = counted ? (u32)driverStats.getAttributeAsInt(primitivesAttribute) : 0;
+		u32 impostorCount = impostors ? impostors->getInstanceCount() : 0;
+		totalDraws += draws;
+		totalPrimitives += primitives;
+		totalImpostors += impostorCount;
+		if (csv)
+		{
+			if (counted)
+				fprintf(csv, "%d,%.3f,%u,%u,%u\n", frame, ms, draws, primitives, impostorCount);
+			else
+				fprintf(csv, "%d,%.3f,,,%u\n", frame, ms, impostorCount);
+		}
+
+		if (frame % BENCH_GOLDEN_INTERVAL == 0)
+		{
+			char path[256];
+			snprintf(path, sizeof(path), "%s/frame_%03d.png", BENCH_GOLDEN_DIR, frame);
+
+			video::IImage* image = driver->createScreenShot(ECF_R8G8B8);
+			if (!image)
+			{
+				printf("frame %3d: no screenshot\n", frame);
+				failed++;
+			}
+			else if (updateGolden)
+			{
+				bool written = driver->writeImageToFile(image, path);
+				printf("frame %3d: %s %s\n", frame, written ? "wrote" : "could not write", path);
+				if (!written)
+					failed++;
+			}
+			else
+			{
+				video::IImage* golden = driver->createImageFromFile(path);
+				if (!golden || golden->getDimension() != image->getDimension())
+				{
+					printf("frame %3d: %s missing or a different size\n", frame, path);
+					failed++;
+				}
+				else
+				{
+					u32 maxDelta;
+					f32 off = compareImages(image, golden, maxDelta);
+					bool pass = off <= BENCH_GOLDEN_MAX_OFF;
+					printf("frame %3d: %6.2f%% pixels off, max delta %3u  %s\n", frame, off * 100.0f, maxDelta, pass ? "ok" : "FAILED");
+					if (!pass)
+					{
+						snprintf(path, sizeof(path), "bench_render_%03d.png", frame);
+						driver->writeImageToFile(image, path);
+						failed++;
+					}
+				}
+				if (golden)
+					golden->drop();
+			}
+			if (image)
+				image->drop();
+		}
+
+		if (present)
+			driver->endScene();
+	}
+
+	if (csv)
+		fclose(csv);
+
+	std::vector<f64> sorted = times;
+	std::sort(sorted.begin(), sorted.end());
+	f64 sum = 0.0;
+	for (f64 t : times)
+		sum += t;
+	printf("render ms: avg %.2f, median %.2f, p95 %.2f, max %.2f\n", sum / times.size(),
+		sorted[sorted.size() / 2], sorted[sorted.size() * 95 / 100], sorted.back());
+	if (counted)
+		printf("per frame: %.1f draw calls, %.0f primitives, %.1f impostors (per-frame log in %s)\n",
+			(f64)totalDraws / BENCH_RENDER_FRAMES, (f64)totalPrimitives / BENCH_RENDER_FRAMES,
+			(f64)totalImpostors / BENCH_RENDER_FRAMES, BENCH_RENDER_CSV);
+	else
+		printf("per frame: draw calls and primitives n/a (Irrlicht built without the DrawCalls and PrimitivesDrawn "
+			"driver attributes), %.1f impostors (per-frame log in %s)\n", (f64)totalImpostors / BENCH_RENDER_FRAMES, BENCH_RENDER_CSV);
+	if (!updateGolden)
+		printf("golden frames: %s\n", failed ? "FAILED" : "all within tolerance");
+
+	device->drop();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Headless benchmarks, run from the command line instead of the game:
+//   Survive.exe --bench-physics-threads
+//   Survive.exe --bench-broadphase
+//   Survive.exe --bench-md2
+//   Survive.exe --bench-software
+//   Survive.exe --bench-render [--update-golden]
+namespace Benchmark
+{
+	// Step time versus enemy count for 1, 2, 4 and 8 physics threads
+	int runPhysicsThreads();
+
+	// Pair-update and ray-query cost of each broadphase under enemy swarms
+	int runBroadphase();
+
+	// MD2 vertex interpolation cost for the player, enemy and fog enemy meshes
+	int runMD2Interpolation();
+
+	// Arena render time on the Burning's Video software rasterizer, with and
+	// without a fog cloud
+	int runSoftwareRaster();
+
+	// Scripted camera lap over the arena with enemies and a fog cloud on the
+	// software driver: per-frame render time, draw calls and triangles, and
+	// selected frames checked against golden images (or rewritten with
+	// updateGolden). Returns non-zero if a frame is off.
+	int runRenderFrames(bool updateGolden);
+}
@@ -0,0 +1,94 @@
+#include "BlobShadowRenderer.h"
+#include "QuadBatch.h"
+
+static const u32 BLOB_TEXTURE_SIZE = 64;
+static const u32 MAX_BLOB_SHADOWS = 65536 / 4; // 16-bit indices
+
+BlobShadowRenderer::BlobShadowRenderer(f32 groundY, ISceneNode* parent, ISceneManager* smgr, s32 id)
+	: ISceneNode(parent, smgr, id)
+	, m_groundY(groundY)
+	, m_drawnCount(0)
+{
+	// Casters are spread over the whole arena; skip the node-level box test
+	setAutomaticCulling(EAC_OFF);
+
+	// Dark circle fading out towards the edge
+	ITexture* texture = QuadBatch::createRoundTexture(smgr->getVideoDriver(), "blob_shadow",
+		BLOB_TEXTURE_SIZE, SColor(120, 0, 0, 0), 1);
+
+	m_material.setTexture(0, texture);
+	m_material.MaterialType = EMT_TRANSPARENT_ALPHA_CHANNEL;
+	m_material.Lighting = false;
+	m_material.BackfaceCulling = false;
+	m_material.ZWriteEnable = false;
+}
+
+BlobShadowRenderer::~BlobShadowRenderer()
+{
+	for (u32 i = 0; i < m_casters.size(); i++)
+		m_casters[i].node->drop();
+}
+
+void BlobShadowRenderer::addCaster(ISceneNode* node, f32 radius)
+{
+	if (!node || m_casters.size() >= MAX_BLOB_SHADOWS)
+		return;
+
+	node->grab();
+	Caster caster = { node, radius };
+	m_casters.push_back(caster);
+}
+
+void BlobShadowRenderer::removeCaster(ISceneNode* node)
+{
+	for (u32 i = 0; i < m_casters.size(); i++)
+	{
+		if (m_casters[i].node == node)
+		{
+			node->drop();
+			m_casters.erase(i);
+			return;
+		}
+	}
+}
+
+void BlobShadowRenderer::OnRegisterSceneNode()
+{
+	// A caster without a parent was removed from the scene (enemy deleted)
+	for (s32 i = (s32)m_casters.size() - 1; i >= 0; i--)
+	{
+		if (!m_casters[i].node->getParent())
+		{
+			m_casters[i].node->drop();
+			m_casters.erase(i);
+		}
+	}
+
+	m_drawnCount = 0;
+	if (IsVisible && !m_casters.empty())
+		SceneManager->registerNodeForRendering(this, ESNRP_TRANSPARENT);
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+void BlobShadowRenderer::render()
+{
+	m_vertices.set_used(0);
+	for (u32 i = 0; i < m_casters.size(); i++)
+	{
+		const Caster& caster = m_casters[i];
+		if (!caster.node->isTrulyVisible())
+			continue;
+
+		vector3df pos = caster.node->getAbsolutePosition();
+		const f32 r = caster.radius;
+		const SColor white(255, 255, 255, 255);
+		const vector3df up(0, 1, 0);
+		m_vertices.push_back(S3DVertex(pos.X - r, m_groundY, pos.Z - r, up.X, up.Y, up.Z, white, 0.0f, 1.0f));
+		m_vertices.push_back(S3DVertex(pos.X - r, m_groundY, pos.Z + r, up.X, up.Y, up.Z, white, 0.0f, 0.0f));
+		m_vertices.push_back(S3DVertex(pos.X + r, m_groundY, pos.Z + r, up.X, up.Y, up.Z, white, 1.0f, 0.0f));
+		m_vertices.push_back(S3DVertex(pos.X + r, m_groundY, pos.Z - r, up.X, up.Y, up.Z, white, 1.0f, 1.0f));
+	}
+
+	m_drawnCount = QuadBatch::draw(SceneManager->getVideoDriver(), m_material, m_vertices, m_indices);
+}
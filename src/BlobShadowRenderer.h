@@ -0,0 +1,45 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Blob shadows for every actor from one scene node: a single procedural
+// texture and one dynamic quad list, rebuilt and drawn in one call per frame.
+// Casters are grabbed and dropped automatically once they are removed from
+// the scene, so owners don't have to unregister them.
+class BlobShadowRenderer : public ISceneNode
+{
+public:
+	BlobShadowRenderer(f32 groundY, ISceneNode* parent, ISceneManager* smgr, s32 id = -1);
+	~BlobShadowRenderer();
+
+	void addCaster(ISceneNode* node, f32 radius);
+	void removeCaster(ISceneNode* node);
+
+	void OnRegisterSceneNode() override;
+	void render() override;
+	const aabbox3df& getBoundingBox() const override { return m_box; }
+	u32 getMaterialCount() const override { return 1; }
+	SMaterial& getMaterial(u32 i) override { return m_material; }
+
+	u32 getCasterCount() const { return m_casters.size(); }
+	u32 getDrawnCount() const { return m_drawnCount; }
+
+private:
+	struct Caster
+	{
+		ISceneNode* node;
+		f32 radius;
+	};
+
+	array<Caster>    m_casters;
+	array<S3DVertex> m_vertices;
+	array<u16>       m_indices;
+	SMaterial        m_material;
+	aabbox3df        m_box;
+	f32              m_groundY;
+	u32              m_drawnCount;
+};
@@ -0,0 +1,510 @@
+#include "ChunkedMeshSceneNode.h"
+#include "MeshDecimator.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Share of the full triangle count each level aims for, and how far (in
+// map model units) it may move the surface to get there. A level stops
+// early when the error bound or the locked seams allow no more collapses.
+static const f32 LOD_TRIANGLE_RATIO[ChunkedMeshSceneNode::MAX_LODS] = { 1.0f, 0.5f, 0.2f };
+static const f32 LOD_MAX_ERROR[ChunkedMeshSceneNode::MAX_LODS] = { 0.0f, 0.25f, 1.0f };
+static const f32 LOD_DEFAULT_ERROR_PIXELS = 1.0f;
+
+// Bump when the decimation changes, so stale bakes are ignored and rebuilt.
+// Changes to the map or the chunk grid are caught by the per-chunk counts.
+static const u32 MAP_LOD_VERSION = 1;
+static const char MAP_LOD_MAGIC[4] = { 'M', 'L', 'O', 'D' };
+
+struct MapLodFileHeader
+{
+	char magic[4];
+	u32  version;
+	u32  chunkCount;
+	u32  levelCount;
+};
+
+// One per chunk and level above 0, followed by the vertices and indices
+struct MapLodFileLevel
+{
+	u32 fullVertices;  // level 0 counts of the chunk, to catch a changed map
+	u32 fullTriangles;
+	f32 error;
+	u32 vertexCount;
+	u32 indexCount;
+};
+
+namespace
+{
+	// A chunk vertex by position, to find the positions used by several chunks
+	struct SeamKey
+	{
+		f32 x, y, z;
+		u32 chunk;
+		u32 vertex;
+
+		bool samePosition(const SeamKey& other) const
+		{
+			return x == other.x && y == other.y && z == other.z;
+		}
+
+		bool operator<(const SeamKey& other) const
+		{
+			if (x != other.x) return x < other.x;
+			if (y != other.y) return y < other.y;
+			if (z != other.z) return z < other.z;
+			return chunk < other.chunk;
+		}
+	};
+
+	// Cache orders a decimated buffer the same way the full map was at load
+	SMeshBuffer* optimizeLevel(SMeshBuffer* buffer)
+	{
+		SMesh mesh;
+		mesh.addMeshBuffer(buffer);
+		SMesh* optimized = MeshOptimizer::optimize(&mesh);
+		if (optimized->getMeshBufferCount() != 1)
+		{
+			optimized->drop();
+			buffer->grab();
+			return buffer;
+		}
+
+		SMeshBuffer* result = static_cast<SMeshBuffer*>(optimized->getMeshBuffer(0));
+		result->grab();
+		optimized->drop();
+		return result;
+	}
+}
+
+ChunkedMeshSceneNode::ChunkedMeshSceneNode(IMesh* mesh, u32 gridSize, ISceneNode* parent, ISceneManager* smgr, s32 id)
+	: ISceneNode(parent, smgr, id)
+	, m_stats{ 0, 0, 0, 0, 0, { 0, 0, 0 } }
+	, m_lodCount(1)
+	, m_lodErrorThreshold(LOD_DEFAULT_ERROR_PIXELS)
+{
+	if (mesh)
+		buildChunks(mesh, gridSize > 0 ? gridSize : 1);
+}
+
+ChunkedMeshSceneNode::~ChunkedMeshSceneNode()
+{
+	dropLods();
+	for (u32 i = 0; i < m_chunks.size(); i++)
+		m_chunks[i].levels[0]->drop();
+}
+
+void ChunkedMeshSceneNode::buildChunks(IMesh* mesh, u32 gridSize)
+{
+	m_box = mesh->getBoundingBox();
+	const vector3df extent = m_box.getExtent();
+	const f32 cellX = extent.X > 0.0f ? extent.X / gridSize : 1.0f;
+	const f32 cellZ = extent.Z > 0.0f ? extent.Z / gridSize : 1.0f;
+	const u32 numCells = gridSize * gridSize;
+
+	array<u32> triangleCell;
+	array<s32> remap;
+
+	for (u32 b = 0; b < mesh->getMeshBufferCount(); b++)
+	{
+		IMeshBuffer* src = mesh->getMeshBuffer(b);
+		if (src->getVertexType() != EVT_STANDARD || src->getIndexType() != EIT_16BIT)
+			continue;
+
+		const S3DVertex* vertices = static_cast<const S3DVertex*>(src->getVertices());
+		const u16* indices = src->getIndices();
+		const u32 triangleCount = src->getIndexCount() / 3;
+		if (triangleCount == 0)
+			continue;
+
+		const u32 materialIndex = m_materials.size();
+		m_materials.push_back(src->getMaterial());
+
+		// Bin triangles by the cell holding their centroid
+		triangleCell.set_used(triangleCount);
+		for (u32 t = 0; t < triangleCount; t++)
+		{
+			vector3df centroid = (vertices[indices[t * 3]].Pos + vertices[indices[t * 3 + 1]].Pos
+				+ vertices[indices[t * 3 + 2]].Pos) / 3.0f;
+			s32 x = (s32)((centroid.X - m_box.MinEdge.X) / cellX);
+			s32 z = (s32)((centroid.Z - m_box.MinEdge.Z) / cellZ);
+			x = core::clamp<s32>(x, 0, gridSize - 1);
+			z = core::clamp<s32>(z, 0, gridSize - 1);
+			triangleCell[t] = z * gridSize + x;
+		}
+
+		remap.set_used(src->getVertexCount());
+		for (u32 c = 0; c < numCells; c++)
+		{
+			SMeshBuffer* chunk = nullptr;
+			for (u32 v = 0; v < remap.size(); v++)
+				remap[v] = -1;
+
+			for (u32 t = 0; t < triangleCount; t++)
+			{
+				if (triangleCell[t] != c)
+					continue;
+
+				if (!chunk)
+				{
+					chunk = new SMeshBuffer();
+					chunk->Material = src->getMaterial();
+				}
+
+				for (u32 k = 0; k < 3; k++)
+				{
+					u16 index = indices[t * 3 + k];
+					if (remap[index] < 0)
+					{
+						remap[index] = chunk->Vertices.size();
+						chunk->Vertices.push_back(vertices[index]);
+					}
+					chunk->Indices.push_back((u16)remap[index]);
+				}
+			}
+
+			if (!chunk)
+				continue;
+
+			chunk->recalculateBoundingBox();
+			chunk->setHardwareMappingHint(EHM_STATIC);
+
+			Chunk entry;
+			entry.levels[0] = chunk;
+			entry.errors[0] = 0.0f;
+			for (u32 l = 1; l < MAX_LODS; l++)
+			{
+				entry.levels[l] = nullptr;
+				entry.errors[l] = 0.0f;
+			}
+			entry.materialIndex = materialIndex;
+			m_chunks.push_back(entry);
+			m_stats.trianglesTotal += chunk->Indices.size() / 3;
+		}
+	}
+
+	m_stats.chunksTotal = m_chunks.size();
+}
+
+void ChunkedMeshSceneNode::dropLods()
+{
+	for (u32 i = 0; i < m_chunks.size(); i++)
+	{
+		for (u32 l = 1; l < MAX_LODS; l++)
+		{
+			if (m_chunks[i].levels[l])
+				m_chunks[i].levels[l]->drop();
+			m_chunks[i].levels[l] = nullptr;
+			m_chunks[i].errors[l] = 0.0f;
+		}
+	}
+	m_lodCount = 1;
+}
+
+void ChunkedMeshSceneNode::buildLods()
+{
+	dropLods();
+
+	// Chunks copy their vertices from the same source buffers, so a position
+	// on a seam is bit-identical in every chunk that uses it
+	array<SeamKey> keys;
+	for (u32 i = 0; i < m_chunks.size(); i++)
+	{
+		const SMeshBuffer* buffer = m_chunks[i].levels[0];
+		for (u32 v = 0; v < buffer->Vertices.size(); v++)
+		{
+			const vector3df& pos = buffer->Vertices[v].Pos;
+			SeamKey key = { pos.X, pos.Y, pos.Z, i, v };
+			keys.push_back(key);
+		}
+	}
+	keys.sort();
+
+	array<array<bool> > locked;
+	locked.reallocate(m_chunks.size());
+	for (u32 i = 0; i < m_chunks.size(); i++)
+	{
+		locked.push_back(array<bool>());
+		locked[i].set_used(m_chunks[i].levels[0]->Vertices.size());
+		for (u32 v = 0; v < locked[i].size(); v++)
+			locked[i][v] = false;
+	}
+
+	for (u32 first = 0; first < keys.size();)
+	{
+		u32 last = first + 1;
+		bool shared = false;
+		while (last < keys.size() && keys[last].samePosition(keys[first]))
+		{
+			shared |= keys[last].chunk != keys[first].chunk;
+			last++;
+		}
+
+		if (shared)
+		{
+			for (u32 k = first; k < last; k++)
+				locked[keys[k].chunk][keys[k].vertex] = true;
+		}
+		first = last;
+	}
+
+	// Every level is decimated from the full chunk, so its error is measured
+	// against the real surface rather than piling up level on level
+	for (u32 i = 0; i < m_chunks.size(); i++)
+	{
+		Chunk& chunk = m_chunks[i];
+		const u32 fullTriangles = chunk.levels[0]->Indices.size() / 3;
+		for (u32 l = 1; l < MAX_LODS; l++)
+		{
+			const u32 target = (u32)(fullTriangles * LOD_TRIANGLE_RATIO[l]);
+			f32 error = 0.0f;
+			SMeshBuffer* decimated = MeshDecimator::decimate(chunk.levels[0], target, LOD_MAX_ERROR[l], &locked[i], &error);
+			chunk.levels[l] = optimizeLevel(decimated);
+			chunk.levels[l]->recalculateBoundingBox();
+			chunk.levels[l]->setHardwareMappingHint(EHM_STATIC);
+			chunk.errors[l] = error;
+			decimated->drop();
+		}
+	}
+
+	m_lodCount = MAX_LODS;
+}
+
+bool ChunkedMeshSceneNode::loadLods(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file)
+		return false;
+
+	MapLodFileHeader header;
+	bool ok = fread(&header, sizeof(header), 1, file) == 1
+		&& memcmp(header.magic, MAP_LOD_MAGIC, sizeof(header.magic)) == 0
+		&& header.version == MAP_LOD_VERSION
+		&& header.chunkCount == m_chunks.size()
+		&& header.levelCount > 1 && header.levelCount <= MAX_LODS;
+
+	// Read everything before touching the chunks, so a bad file changes nothing
+	array<SMeshBuffer*> buffers;
+	array<f32> errors;
+	for (u32 i = 0; ok && i < header.chunkCount; i++)
+	{
+		const SMeshBuffer* full = m_chunks[i].levels[0];
+		for (u32 l = 1; ok && l < header.levelCount; l++)
+		{
+			MapLodFileLevel data;
+			ok = fread(&data, sizeof(data), 1, file) == 1
+				&& data.fullVertices == full->Vertices.size()
+				&& data.fullTriangles == full->Indices.size() / 3
+				&& data.vertexCount > 0 && data.vertexCount <= 65536
+				&& data.indexCount > 0 && data.indexCount % 3 == 0;
+			if (!ok)
+				break;
+
+			SMeshBuffer* buffer = new SMeshBuffer();
+			buffer->Material = full->Material;
+			buffer->Vertices.set_used(data.vertexCount);
+			buffer->Indices.set_used(data.indexCount);
+			buffers.push_back(buffer);
+			errors.push_back(data.error);
+
+			ok = fread(buffer->Vertices.pointer(), sizeof(S3DVertex), data.vertexCount, file) == data.vertexCount
+				&& fread(buffer->Indices.pointer(), sizeof(u16), data.indexCount, file) == data.indexCount;
+			for (u32 k = 0; ok && k < data.indexCount; k++)
+				ok = buffer->Indices[k] < data.vertexCount;
+		}
+	}
+	fclose(file);
+
+	if (!ok)
+	{
+		for (u32 b = 0; b < buffers.size(); b++)
+			buffers[b]->drop();
+		return false;
+	}
+
+	dropLods();
+	u32 next = 0;
+	for (u32 i = 0; i < m_chunks.size(); i++)
+	{
+		for (u32 l = 1; l < header.levelCount; l++)
+		{
+			SMeshBuffer* buffer = buffers[next];
+			buffer->recalculateBoundingBox();
+			buffer->setHardwareMappingHint(EHM_STATIC);
+			m_chunks[i].levels[l] = buffer;
+			m_chunks[i].errors[l] = errors[next];
+			next++;
+		}
+	}
+	m_lodCount = header.levelCount;
+	return true;
+}
+
+bool ChunkedMeshSceneNode::saveLods(const char* path) const
+{
+	if (m_lodCount < 2)
+		return false;
+
+	FILE* file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	MapLodFileHeader header;
+	memcpy(header.magic, MAP_LOD_MAGIC, sizeof(header.magic));
+	header.version = MAP_LOD_VERSION;
+	header.chunkCount = m_chunks.size();
+	header.levelCount = m_lodCount;
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+	for (u32 i = 0; ok && i < m_chunks.size(); i++)
+	{
+		const Chunk& chunk = m_chunks[i];
+		for (u32 l = 1; ok && l < m_lodCount; l++)
+		{
+			const SMeshBuffer* buffer = chunk.levels[l];
+
+			MapLodFileLevel data;
+			data.fullVertices = chunk.levels[0]->Vertices.size();
+			data.fullTriangles = chunk.levels[0]->Indices.size() / 3;
+			data.error = chunk.errors[l];
+			data.vertexCount = buffer->Vertices.size();
+			data.indexCount = buffer->Indices.size();
+			ok = fwrite(&data, sizeof(data), 1, file) == 1
+				&& fwrite(buffer->Vertices.const_pointer(), sizeof(S3DVertex), data.vertexCount, file) == data.vertexCount
+				&& fwrite(buffer->Indices.const_pointer(), sizeof(u16), data.indexCount, file) == data.indexCount;
+		}
+	}
+
+	fclose(file);
+	return ok;
+}
+
+u32 ChunkedMeshSceneNode::getLodTriangles(u32 level) const
+{
+	u32 triangles = 0;
+	if (level < m_lodCount)
+	{
+		for (u32 i = 0; i < m_chunks.size(); i++)
+			triangles += m_chunks[i].levels[level]->Indices.size() / 3;
+	}
+	return triangles;
+}
+
+f32 ChunkedMeshSceneNode::getLodError(u32 level) const
+{
+	f32 error = 0.0f;
+	if (level < m_lodCount)
+	{
+		for (u32 i = 0; i < m_chunks.size(); i++)
+			error = core::max_(error, m_chunks[i].errors[level]);
+	}
+	return error;
+}
+
+void ChunkedMeshSceneNode::OnRegisterSceneNode()
+{
+	m_stats.trianglesSubmitted = 0;
+	m_stats.trianglesFullDetail = 0;
+	m_stats.chunksVisible = 0;
+	for (u32 l = 0; l < MAX_LODS; l++)
+		m_stats.chunksAtLod[l] = 0;
+
+	if (!IsVisible)
+		return;
+
+	IVideoDriver* driver = SceneManager->getVideoDriver();
+	bool hasSolid = false, hasTransparent = false;
+	for (u32 i = 0; i < m_materials.size(); i++)
+	{
+		IMaterialRenderer* renderer = driver->getMaterialRenderer(m_materials[i].MaterialType);
+		if (renderer && renderer->isTransparent())
+			hasTransparent = true;
+		else
+			hasSolid = true;
+	}
+
+	if (hasSolid)
+		SceneManager->registerNodeForRendering(this, ESNRP_SOLID);
+	if (hasTransparent)
+		SceneManager->registerNodeForRendering(this, ESNRP_TRANSPARENT);
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+void ChunkedMeshSceneNode::render()
+{
+	IVideoDriver* driver = SceneManager->getVideoDriver();
+	ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+		return;
+
+	const bool transparentPass = SceneManager->getSceneNodeRenderPass() == ESNRP_TRANSPARENT;
+	driver->setTransform(ETS_WORLD, AbsoluteTransformation);
+
+	// Cull in object space: bring the frustum to the node instead of every box to the world
+	SViewFrustum frustum = *camera->getViewFrustum();
+	const vector3df cameraPos = camera->getAbsolutePosition();
+	vector3df localCamera = cameraPos;
+	if (!AbsoluteTransformation.isIdentity())
+	{
+		matrix4 invTransform(AbsoluteTransformation, matrix4::EM4CONST_INVERSE);
+		frustum.transform(invTransform);
+		invTransform.transformVect(localCamera);
+	}
+
+	// Pixels covered by one world unit at distance 1; object space errors
+	// are scaled by the node's largest axis scale to be safe
+	const vector3df scale = AbsoluteTransformation.getScale();
+	const f32 maxScale = core::max_(scale.X, scale.Y, scale.Z);
+	const f32 pixelsPerUnit = driver->getCurrentRenderTargetSize().Height
+		/ (2.0f * tanf(camera->getFOV() * 0.5f));
+	const f32 errorToPixels = maxScale * pixelsPerUnit;
+
+	for (u32 i = 0; i < m_chunks.size(); i++)
+	{
+		const Chunk& chunk = m_chunks[i];
+		const SMaterial& material = m_materials[chunk.materialIndex];
+		IMaterialRenderer* renderer = driver->getMaterialRenderer(material.MaterialType);
+		if ((renderer && renderer->isTransparent()) != transparentPass)
+			continue;
+
+		// Lower levels only ever lose vertices, so the full box holds them all
+		const aabbox3df& box = chunk.levels[0]->getBoundingBox();
+		bool visible = true;
+		for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT && visible; p++)
+			visible = box.classifyPlaneRelation(frustum.planes[p]) != ISREL3D_FRONT;
+		if (!visible)
+			continue;
+
+		// Distance from the camera to the nearest point of the chunk
+		u32 level = 0;
+		if (m_lodCount > 1)
+		{
+			vector3df nearest(
+				core::clamp(localCamera.X, box.MinEdge.X, box.MaxEdge.X),
+				core::clamp(localCamera.Y, box.MinEdge.Y, box.MaxEdge.Y),
+				core::clamp(localCamera.Z, box.MinEdge.Z, box.MaxEdge.Z));
+			AbsoluteTransformation.transformVect(nearest);
+			const f32 distance = core::max_(nearest.getDistanceFrom(cameraPos), 1.0f);
+
+			for (u32 l = m_lodCount - 1; l > 0; l--)
+			{
+				if (chunk.errors[l] * errorToPixels / distance <= m_lodErrorThreshold)
+				{
+					level = l;
+					break;
+				}
+			}
+		}
+
+		SMeshBuffer* buffer = chunk.levels[level];
+		driver->setMaterial(material);
+		driver->drawMeshBuffer(buffer);
+
+		m_stats.chunksVisible++;
+		m_stats.chunksAtLod[level]++;
+		m_stats.trianglesSubmitted += buffer->getIndexCount() / 3;
+		m_stats.trianglesFullDetail += chunk.levels[0]->getIndexCount() / 3;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Static mesh split into an XZ grid of chunks (one mesh buffer per chunk and
+// material) so render() can frustum-cull chunks instead of submitting the
+// whole mesh. Used for the Colosseum, where the third-person camera only sees
+// a slice of the ring. Only EVT_STANDARD buffers are kept (what the OBJ loader
+// produces).
+//
+// Each chunk can also carry lower detail levels (see buildLods()); render()
+// picks per chunk the coarsest level whose geometric error projects to no
+// more than a pixel threshold at the chunk's distance from the camera.
+class ChunkedMeshSceneNode : public ISceneNode
+{
+public:
+	enum { MAX_LODS = 3 };
+
+	struct CullStats
+	{
+		u32 trianglesSubmitted;
+		u32 trianglesFullDetail; // what the visible chunks would cost at LOD 0
+		u32 trianglesTotal;
+		u32 chunksVisible;
+		u32 chunksTotal;
+		u32 chunksAtLod[MAX_LODS];
+	};
+
+	ChunkedMeshSceneNode(IMesh* mesh, u32 gridSize, ISceneNode* parent, ISceneManager* smgr, s32 id = -1);
+	~ChunkedMeshSceneNode();
+
+	void OnRegisterSceneNode() override;
+	void render() override;
+	const aabbox3df& getBoundingBox() const override { return m_box; }
+	u32 getMaterialCount() const override { return m_materials.size(); }
+	SMaterial& getMaterial(u32 i) override { return m_materials[i]; }
+
+	// Counters of the current frame, summed over the solid and transparent passes
+	const CullStats& getCullStats() const { return m_stats; }
+
+	// Decimates every chunk into the lower levels. Vertices on the border
+	// between two chunks are locked, so neighbours drawn at different levels
+	// still meet without cracks. Takes a few seconds on the Colosseum, so the
+	// result is meant to be baked with saveLods() and reloaded with loadLods().
+	void buildLods();
+	bool loadLods(const char* path);
+	bool saveLods(const char* path) const;
+
+	u32 getLodCount() const { return m_lodCount; }
+	u32 getLodTriangles(u32 level) const;
+	// Largest error of a level over all chunks, in object units
+	f32 getLodError(u32 level) const;
+
+	// A lower level is used while its error covers at most this many pixels
+	void setLodErrorThreshold(f32 pixels) { m_lodErrorThreshold = pixels; }
+	f32 getLodErrorThreshold() const { return m_lodErrorThreshold; }
+
+private:
+	struct Chunk
+	{
+		SMeshBuffer* levels[MAX_LODS]; // levels[0] is the full mesh
+		f32 errors[MAX_LODS];          // object units, 0 for level 0
+		u32 materialIndex;
+	};
+
+	void buildChunks(IMesh* mesh, u32 gridSize);
+	void dropLods();
+
+	array<Chunk>     m_chunks;
+	array<SMaterial> m_materials;
+	aabbox3df        m_box;
+	CullStats        m_stats;
+	u32              m_lodCount;
+	f32              m_lodErrorThreshold;
+};
@@ -1,32 +1,76 @@
 #include "DebugDrawer.h"
 
+static const u32 MAX_BATCH_VERTICES = 65536; // 16-bit indices
+
 DebugDrawer::DebugDrawer(IVideoDriver* driver)
 	: m_driver(driver)
 	, m_debugMode(DBG_DrawWireframe)
+	, m_filterRadius(0.0f)
+	, m_lineCount(0)
+	, m_drawCalls(0)
 {
+	// No lighting so lines are visible
+	m_material.Lighting = false;
+	m_material.Thickness = 1.0f;
+
+	// Line list indices are just 0..n-1; build them once
+	m_indices.reallocate(MAX_BATCH_VERTICES);
+	for (u32 i = 0; i < MAX_BATCH_VERTICES; i++)
+		m_indices.push_back((u16)i);
 }
 
 void DebugDrawer::beginDraw()
 {
-	// Reset world transform to identity so lines draw in world space
-	m_driver->setTransform(irr::video::ETS_WORLD, irr::core::matrix4());
+	m_vertices.set_used(0);
+	m_lineCount = 0;
+	m_drawCalls = 0;
+}
 
-	// Set material with no lighting so lines are visible
-	irr::video::SMaterial material;
-	material.Lighting = false;
-	material.Thickness = 1.0f;
-	m_driver->setMaterial(material);
+void DebugDrawer::endDraw()
+{
+	flush();
+}
+
+void DebugDrawer::setFilter(const core::vector3df& center, f32 radius)
+{
+	m_filterCenter = center;
+	m_filterRadius = radius;
+}
+
+void DebugDrawer::flush()
+{
+	if (m_vertices.empty())
+		return;
+
+	// Reset world transform to identity so lines draw in world space
+	m_driver->setTransform(ETS_WORLD, core::IdentityMatrix);
+	m_driver->setMaterial(m_material);
+	m_driver->drawVertexPrimitiveList(m_vertices.pointer(), m_vertices.size(), m_indices.pointer(),
+		m_vertices.size() / 2, EVT_STANDARD, scene::EPT_LINES, EIT_16BIT);
+	m_drawCalls++;
+	m_vertices.set_used(0);
 }
 
 void DebugDrawer::drawLine(const btVector3& from, const btVector3& to, const btVector3& color)
 {
-	// Override Bullet's color with yellow for all wireframes
-	SColor irrColor(255, 255, 255, 0);
+	const core::vector3df a(from.getX(), from.getY(), from.getZ());
+	const core::vector3df b(to.getX(), to.getY(), to.getZ());
+
+	if (m_filterRadius > 0.0f)
+	{
+		const core::vector3df closest = core::line3df(a, b).getClosestPoint(m_filterCenter);
+		if (closest.getDistanceFromSQ(m_filterCenter) > m_filterRadius * m_filterRadius)
+			return;
+	}
 
-	m_driver->draw3DLine(
-		core::vector3df(from.getX(), from.getY(), from.getZ()),
-		core::vector3df(to.getX(), to.getY(), to.getZ()),
-		irrColor);
+	if (m_vertices.size() + 2 > MAX_BATCH_VERTICES)
+		flush();
+
+	// Override Bullet's color with yellow for all wireframes
+	const SColor irrColor(255, 255, 255, 0);
+	m_vertices.push_back(S3DVertex(a, core::vector3df(0, 1, 0), irrColor, core::vector2df(0, 0)));
+	m_vertices.push_back(S3DVertex(b, core::vector3df(0, 1, 0), irrColor, core::vector2df(0, 0)));
+	m_lineCount++;
 }
 
 void DebugDrawer::drawContactPoint(const btVector3& pointOnB, const btVector3& normalOnB,
@@ -5,12 +5,20 @@
 using namespace irr;
 using namespace video;
 
+// Collects Bullet's debug lines for a frame and submits them as line lists,
+// one drawVertexPrimitiveList per 64K vertices instead of one draw3DLine per
+// segment. Lines are only visible after endDraw().
 class DebugDrawer : public btIDebugDraw
 {
 public:
 	DebugDrawer(IVideoDriver* driver);
 
 	void beginDraw();
+	void endDraw();
+
+	// Only keep lines passing within radius of center; radius 0 keeps all
+	void setFilter(const core::vector3df& center, f32 radius);
+
 	void drawLine(const btVector3& from, const btVector3& to, const btVector3& color) override;
 	void drawContactPoint(const btVector3& pointOnB, const btVector3& normalOnB,
 		btScalar distance, int lifeTime, const btVector3& color) override;
@@ -19,7 +27,22 @@ public:
 	void setDebugMode(int debugMode) override;
 	int getDebugMode() const override;
 
+	u32 getLineCount() const { return m_lineCount; }
+	u32 getDrawCallCount() const { return m_drawCalls; }
+
 private:
+	void flush();
+
 	IVideoDriver* m_driver;
 	int m_debugMode;
+
+	core::array<S3DVertex> m_vertices;
+	core::array<u16>       m_indices;
+	SMaterial              m_material;
+
+	core::vector3df m_filterCenter;
+	f32             m_filterRadius;
+
+	u32 m_lineCount;
+	u32 m_drawCalls;
 };
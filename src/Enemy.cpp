@@ -117,8 +117,6 @@ Enemy::Enemy(ISceneManager* smgr, IVideoDriver* driver, Physics* physics, const
 				m_animNode->setMD2Animation(EMAT_RUN);
 			else
 				m_animNode->setMD2Animation(EMAT_STAND);
-
-			m_animNode->addShadowVolumeSceneNode();
 		}
 	}
 
@@ -491,7 +489,6 @@ void Enemy::takeDamage(s32 amount)
 
 		if (m_animNode)
 			m_animNode->setMD2Animation(EMAT_PAIN_A);
-			m_animNode->setMD2Animation(EMAT_PAIN_A);
 		if (m_soundEngine)
 		{
 			irrklang::ISound* s = m_soundEngine->play2D("assets/audio/enemies/hurt.mp3", false, true, true);
@@ -0,0 +1,286 @@
+#include "FogCloudRenderer.h"
+#include "QuadBatch.h"
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FOG_CLOUD_SSE
+#include <xmmintrin.h>
+#endif
+
+static const u32 PUFF_TEXTURE_SIZE = 64;
+
+static const u32 CLOUD_BURST = 32;          // puffs on impact
+static const f32 CLOUD_EMIT_RATE = 24.0f;   // puffs per second at full strength
+static const f32 CLOUD_SPAWN_RADIUS = 60.0f;
+static const f32 CLOUD_SPAWN_HEIGHT = 40.0f;
+static const f32 CLOUD_SPREAD_SPEED = 70.0f;
+static const f32 CLOUD_RISE_SPEED = 15.0f;
+static const f32 CLOUD_BUOYANCY = 6.0f;
+static const f32 CLOUD_DRAG = 1.2f;         // velocity falls off by e^(-drag * t)
+static const f32 PUFF_LIFE_MIN = 2.0f;
+static const f32 PUFF_LIFE_MAX = 3.2f;
+static const f32 PUFF_SIZE_MIN = 50.0f;     // half size of the quad
+static const f32 PUFF_SIZE_MAX = 80.0f;
+static const f32 PUFF_GROWTH = 30.0f;       // per second
+static const f32 PUFF_ALPHA = 140.0f;
+static const f32 PUFF_FADE_IN = 0.15f;      // of the puff's life
+static const f32 PUFF_FADE_OUT = 0.5f;
+
+static f32 randomRange(f32 lo, f32 hi)
+{
+	return lo + static_cast<f32>(rand()) / RAND_MAX * (hi - lo);
+}
+
+FogCloudRenderer::FogCloudRenderer(SColor color, ISceneNode* parent, ISceneManager* smgr, s32 id)
+	: ISceneNode(parent, smgr, id)
+	, m_color(color)
+	, m_particleCount(0)
+{
+	// Clouds can be anywhere in the arena; skip the node-level box test
+	setAutomaticCulling(EAC_OFF);
+
+	const u32 capacity = getCapacity();
+	array<f32>* streams[] = { &m_posX, &m_posY, &m_posZ, &m_velX, &m_velY, &m_velZ, &m_age, &m_life, &m_size };
+	for (array<f32>* stream : streams)
+	{
+		stream->reallocate(capacity);
+		stream->set_used(capacity);
+	}
+	clear();
+
+	// Soft round puff; the vertex color tints it and carries the opacity
+	ITexture* texture = QuadBatch::createRoundTexture(smgr->getVideoDriver(), "fog_cloud",
+		PUFF_TEXTURE_SIZE, SColor(255, 255, 255, 255), 2);
+
+	m_material.setTexture(0, texture);
+	m_material.MaterialType = EMT_ONETEXTURE_BLEND;
+	m_material.MaterialTypeParam = pack_textureBlendFunc(EBF_SRC_ALPHA, EBF_ONE_MINUS_SRC_ALPHA,
+		EMFN_MODULATE_1X, EAS_TEXTURE | EAS_VERTEX_COLOR);
+	m_material.Lighting = false;
+	m_material.BackfaceCulling = false;
+	m_material.ZWriteEnable = false;
+	m_material.FogEnable = true;
+}
+
+void FogCloudRenderer::feed(u32 id, const vector3df& origin, f32 strength)
+{
+	// Ids only grow, so the lowest one is the oldest cloud; free slots are 0
+	s32 slot = -1;
+	for (u32 c = 0; c < MAX_CLOUDS; c++)
+	{
+		Cloud& cloud = m_clouds[c];
+		if (cloud.id == id)
+		{
+			cloud.strength = strength;
+			cloud.fed = true;
+			return;
+		}
+		if (slot < 0 || cloud.id < m_clouds[slot].id)
+			slot = c;
+	}
+
+	// A cloud that already lost its slot doesn't take one back
+	if (m_clouds[slot].id > id)
+		return;
+
+	const u32 first = slot * PARTICLES_PER_CLOUD;
+	for (u32 i = first; i < first + PARTICLES_PER_CLOUD; i++)
+	{
+		m_age[i] = 0.0f;
+		m_life[i] = 0.0f;
+	}
+
+	Cloud cloud = { id, origin, strength, 0.0f, true, 0 };
+	m_clouds[slot] = cloud;
+	emit(slot, CLOUD_BURST);
+}
+
+void FogCloudRenderer::update(f32 deltaTime)
+{
+	const f32 drag = expf(-CLOUD_DRAG * deltaTime);
+
+	m_particleCount = 0;
+	for (u32 c = 0; c < MAX_CLOUDS; c++)
+	{
+		Cloud& cloud = m_clouds[c];
+		if (!cloud.id)
+			continue;
+
+		if (cloud.fed)
+		{
+			cloud.emitCredit += CLOUD_EMIT_RATE * cloud.strength * deltaTime;
+			const u32 count = (u32)cloud.emitCredit;
+			cloud.emitCredit -= count;
+			emit(c, count);
+		}
+
+		cloud.alive = step(c * PARTICLES_PER_CLOUD, deltaTime, drag);
+		if (!cloud.fed && cloud.alive == 0)
+			cloud.id = 0;
+		cloud.fed = false;
+		m_particleCount += cloud.alive;
+	}
+}
+
+void FogCloudRenderer::clear()
+{
+	for (u32 c = 0; c < MAX_CLOUDS; c++)
+	{
+		Cloud cloud = { 0, vector3df(), 0.0f, 0.0f, false, 0 };
+		m_clouds[c] = cloud;
+	}
+	for (u32 i = 0; i < getCapacity(); i++)
+	{
+		m_age[i] = 0.0f;
+		m_life[i] = 0.0f;
+	}
+	m_particleCount = 0;
+}
+
+void FogCloudRenderer::emit(u32 cloud, u32 count)
+{
+	const vector3df& origin = m_clouds[cloud].origin;
+	const u32 first = cloud * PARTICLES_PER_CLOUD;
+	for (u32 i = first; i < first + PARTICLES_PER_CLOUD && count > 0; i++)
+	{
+		if (m_age[i] < m_life[i])
+			continue;
+
+		// Uniform over a disc around the impact, drifting outwards
+		const f32 angle = randomRange(0.0f, 2.0f * PI);
+		const f32 dist = sqrtf(randomRange(0.0f, 1.0f)) * CLOUD_SPAWN_RADIUS;
+		const f32 dirX = cosf(angle), dirZ = sinf(angle);
+		const f32 speed = randomRange(0.5f, 1.0f) * CLOUD_SPREAD_SPEED;
+
+		m_posX[i] = origin.X + dirX * dist;
+		m_posY[i] = origin.Y + randomRange(0.0f, CLOUD_SPAWN_HEIGHT);
+		m_posZ[i] = origin.Z + dirZ * dist;
+		m_velX[i] = dirX * speed;
+		m_velY[i] = randomRange(0.0f, CLOUD_RISE_SPEED);
+		m_velZ[i] = dirZ * speed;
+		m_age[i] = 0.0f;
+		m_life[i] = randomRange(PUFF_LIFE_MIN, PUFF_LIFE_MAX);
+		m_size[i] = randomRange(PUFF_SIZE_MIN, PUFF_SIZE_MAX);
+		count--;
+	}
+}
+
+// Integrates one cloud's slice and returns how many of its puffs are alive.
+// Free slots are stepped too; with life 0 they stay dead.
+u32 FogCloudRenderer::step(u32 first, f32 deltaTime, f32 drag)
+{
+	f32* posX = &m_posX[first];
+	f32* posY = &m_posY[first];
+	f32* posZ = &m_posZ[first];
+	f32* velX = &m_velX[first];
+	f32* velY = &m_velY[first];
+	f32* velZ = &m_velZ[first];
+	f32* age = &m_age[first];
+	const f32* life = &m_life[first];
+	const f32 lift = CLOUD_BUOYANCY * deltaTime;
+
+	u32 alive = 0;
+#ifdef FOG_CLOUD_SSE
+	static const u32 BIT_COUNT[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	const __m128 dt4 = _mm_set1_ps(deltaTime);
+	const __m128 drag4 = _mm_set1_ps(drag);
+	const __m128 lift4 = _mm_set1_ps(lift);
+	for (u32 i = 0; i < PARTICLES_PER_CLOUD; i += 4)
+	{
+		const __m128 vx = _mm_mul_ps(_mm_loadu_ps(velX + i), drag4);
+		const __m128 vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(velY + i), drag4), lift4);
+		const __m128 vz = _mm_mul_ps(_mm_loadu_ps(velZ + i), drag4);
+		_mm_storeu_ps(velX + i, vx);
+		_mm_storeu_ps(velY + i, vy);
+		_mm_storeu_ps(velZ + i, vz);
+		_mm_storeu_ps(posX + i, _mm_add_ps(_mm_loadu_ps(posX + i), _mm_mul_ps(vx, dt4)));
+		_mm_storeu_ps(posY + i, _mm_add_ps(_mm_loadu_ps(posY + i), _mm_mul_ps(vy, dt4)));
+		_mm_storeu_ps(posZ + i, _mm_add_ps(_mm_loadu_ps(posZ + i), _mm_mul_ps(vz, dt4)));
+
+		const __m128 age4 = _mm_add_ps(_mm_loadu_ps(age + i), dt4);
+		_mm_storeu_ps(age + i, age4);
+		alive += BIT_COUNT[_mm_movemask_ps(_mm_cmplt_ps(age4, _mm_loadu_ps(life + i)))];
+	}
+#else
+	for (u32 i = 0; i < PARTICLES_PER_CLOUD; i++)
+	{
+		velX[i] *= drag;
+		velY[i] = velY[i] * drag + lift;
+		velZ[i] *= drag;
+		posX[i] += velX[i] * deltaTime;
+		posY[i] += velY[i] * deltaTime;
+		posZ[i] += velZ[i] * deltaTime;
+		age[i] += deltaTime;
+		if (age[i] < life[i])
+			alive++;
+	}
+#endif
+	return alive;
+}
+
+u32 FogCloudRenderer::getCloudCount() const
+{
+	u32 count = 0;
+	for (u32 c = 0; c < MAX_CLOUDS; c++)
+		if (m_clouds[c].id)
+			count++;
+	return count;
+}
+
+void FogCloudRenderer::OnRegisterSceneNode()
+{
+	if (IsVisible && m_particleCount > 0)
+		SceneManager->registerNodeForRendering(this, ESNRP_TRANSPARENT);
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+void FogCloudRenderer::render()
+{
+	ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+		return;
+
+	// Camera axes in world space are the rows of the view rotation
+	const matrix4& view = camera->getViewMatrix();
+	const vector3df right(view[0], view[4], view[8]);
+	const vector3df up(view[1], view[5], view[9]);
+	const vector3df normal(-view[2], -view[6], -view[10]);
+
+	m_vertices.set_used(0);
+	for (u32 c = 0; c < MAX_CLOUDS; c++)
+	{
+		const Cloud& cloud = m_clouds[c];
+		if (!cloud.alive)
+			continue;
+
+		const u32 first = c * PARTICLES_PER_CLOUD;
+		for (u32 i = first; i < first + PARTICLES_PER_CLOUD; i++)
+		{
+			if (m_age[i] >= m_life[i])
+				continue;
+
+			const f32 t = m_age[i] / m_life[i];
+			f32 fade = 1.0f;
+			if (t < PUFF_FADE_IN)
+				fade = t / PUFF_FADE_IN;
+			else if (t > 1.0f - PUFF_FADE_OUT)
+				fade = (1.0f - t) / PUFF_FADE_OUT;
+
+			SColor color = m_color;
+			color.setAlpha((u32)(PUFF_ALPHA * fade * cloud.strength));
+
+			const vector3df center(m_posX[i], m_posY[i], m_posZ[i]);
+			const f32 size = m_size[i] + PUFF_GROWTH * m_age[i];
+			const vector3df r = right * size;
+			const vector3df u = up * size;
+			m_vertices.push_back(S3DVertex(center - r - u, normal, color, vector2df(0.0f, 1.0f)));
+			m_vertices.push_back(S3DVertex(center - r + u, normal, color, vector2df(0.0f, 0.0f)));
+			m_vertices.push_back(S3DVertex(center + r + u, normal, color, vector2df(1.0f, 0.0f)));
+			m_vertices.push_back(S3DVertex(center + r - u, normal, color, vector2df(1.0f, 1.0f)));
+		}
+	}
+
+	QuadBatch::draw(SceneManager->getVideoDriver(), m_material, m_vertices, m_indices);
+}
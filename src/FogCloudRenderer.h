@@ -0,0 +1,69 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Local smoke clouds where fog grenades land, drawn as camera-facing puffs.
+// There is a fixed pool of clouds with a fixed number of particles each, so
+// the cost has a hard cap no matter how many fog enemies are throwing; a new
+// cloud takes over the oldest slot once all are in use. Particles live in
+// structure-of-arrays form and are stepped four at a time with SSE where
+// available. All puffs are rebuilt into one quad list and drawn in one call,
+// unsorted: they are all the same color, so blending order barely shows.
+class FogCloudRenderer : public ISceneNode
+{
+public:
+	FogCloudRenderer(SColor color, ISceneNode* parent, ISceneManager* smgr, s32 id = -1);
+
+	// Keeps the cloud with this id emitting for this frame, starting it at
+	// origin if it is new. Strength 0..1 scales emission and opacity. Clouds
+	// not fed in a frame stop emitting and vanish once their puffs are gone.
+	void feed(u32 id, const vector3df& origin, f32 strength);
+	void update(f32 deltaTime);
+	void clear();
+
+	void OnRegisterSceneNode() override;
+	void render() override;
+	const aabbox3df& getBoundingBox() const override { return m_box; }
+	u32 getMaterialCount() const override { return 1; }
+	SMaterial& getMaterial(u32 i) override { return m_material; }
+
+	u32 getCloudCount() const;
+	u32 getParticleCount() const { return m_particleCount; }
+	u32 getCapacity() const { return MAX_CLOUDS * PARTICLES_PER_CLOUD; }
+
+private:
+	// Particles per cloud stay a multiple of 4 for the SSE step
+	enum { MAX_CLOUDS = 8, PARTICLES_PER_CLOUD = 64 };
+
+	struct Cloud
+	{
+		u32 id;            // 0 while the slot is free
+		vector3df origin;
+		f32 strength;
+		f32 emitCredit;    // fractional particles carried to the next frame
+		bool fed;
+		u32 alive;
+	};
+
+	void emit(u32 cloud, u32 count);
+	u32 step(u32 first, f32 deltaTime, f32 drag);
+
+	Cloud m_clouds[MAX_CLOUDS];
+
+	// Particle pool, one fixed slice per cloud. A particle is alive while
+	// age < life; free ones keep life 0.
+	array<f32> m_posX, m_posY, m_posZ;
+	array<f32> m_velX, m_velY, m_velZ;
+	array<f32> m_age, m_life, m_size;
+
+	array<S3DVertex> m_vertices;
+	array<u16>       m_indices;
+	SMaterial        m_material;
+	aabbox3df        m_box;
+	SColor           m_color;
+	u32              m_particleCount;
+};
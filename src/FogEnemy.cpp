@@ -29,7 +29,9 @@ static const f32 FOG_START_INITIAL = 250.0f;
 static const f32 FOG_END_INITIAL = 300.0f;
 static const f32 FOG_START_FINAL = 9999.0f;
 static const f32 FOG_END_FINAL = 10000.0f;
-static const SColor FOG_COLOR(255, 180, 180, 180);
+
+// Every grenade impact gets its own cloud id, across all fog enemies
+static u32 nextFogCloudId = 1;
 
 static const f32 STUCK_TIME_THRESHOLD = 1.0f;
 static const f32 STUCK_DISTANCE_THRESHOLD = 5.0f;
@@ -70,6 +72,8 @@ FogEnemy::FogEnemy(ISceneManager* smgr, IVideoDriver* driver, Physics* physics,
 	, m_fogTimer(0.0f)
 	, m_fogStartDist(FOG_START_FINAL)
 	, m_fogEndDist(FOG_END_FINAL)
+	, m_fogFinished(false)
+	, m_fogCloudId(0)
 	, m_movementSpeed(MOVEMENT_SPEED)
 	, m_lastCheckedPos(spawnPos)
 	, m_stuckTimer(0.0f)
@@ -77,21 +81,19 @@ FogEnemy::FogEnemy(ISceneManager* smgr, IVideoDriver* driver, Physics* physics,
 	, m_strafeTimer(0.0f)
 	, m_strafeDirection(1.0f)
 {
-	IAnimatedMesh* mesh = smgr->getMesh("assets/models/fog_enemy/tris.md2");
+	IAnimatedMesh* mesh = smgr->getMesh("assets/models/fog_enemy/Tris.md2");
 	if (mesh)
 	{
 		m_animNode = smgr->addAnimatedMeshSceneNode(mesh);
 		if (m_animNode)
 		{
-			m_animNode->setMaterialTexture(0, driver->getTexture("assets/models/fog_enemy/default.pcx"));
+			m_animNode->setMaterialTexture(0, driver->getTexture("assets/models/fog_enemy/Default.pcx"));
 			m_animNode->setMaterialFlag(EMF_LIGHTING, false);
 			m_animNode->setMaterialFlag(EMF_FOG_ENABLE, true);
 			m_animNode->setScale(vector3df(1.7f, 1.7f, 1.7f));
 			m_animNode->setAnimationSpeed(24.0f);
 			m_animNode->setPosition(spawnPos);
 			m_animNode->setMD2Animation(EMAT_RUN);
-
-			m_animNode->addShadowVolumeSceneNode();
 		}
 	}
 
@@ -119,10 +121,6 @@ FogEnemy::~FogEnemy()
 
 	if (m_grenadeNode)
 		m_grenadeNode->remove();
-
-	// Disable fog if this enemy had it active
-	if (m_fogActive && m_driver)
-		m_driver->setFog(FOG_COLOR, EFT_FOG_LINEAR, FOG_START_FINAL, FOG_END_FINAL, 0.0f, true, false);
 }
 
 void FogEnemy::update(f32 deltaTime)
@@ -412,7 +410,7 @@ void FogEnemy::spawnGrenade()
 	{
 		m_grenadeNode->setPosition(pos);
 		m_grenadeNode->setMaterialFlag(EMF_LIGHTING, false);
-		m_grenadeNode->setMaterialTexture(0, m_driver->getTexture("assets/models/fog_enemy/default.pcx"));
+		m_grenadeNode->setMaterialTexture(0, m_driver->getTexture("assets/models/fog_enemy/Default.pcx"));
 	}
 
 	f32 yawRad = m_rotationY * core::DEGTORAD;
@@ -433,7 +431,7 @@ void FogEnemy::updateGrenade(f32 deltaTime)
 
 	if (pos.Y <= 0.0f)
 	{
-		activateFog();
+		activateFog(vector3df(pos.X, 0.0f, pos.Z));
 
 		m_grenadeNode->remove();
 		m_grenadeNode = nullptr;
@@ -441,15 +439,14 @@ void FogEnemy::updateGrenade(f32 deltaTime)
 	}
 }
 
-void FogEnemy::activateFog()
+void FogEnemy::activateFog(const vector3df& origin)
 {
+	m_fogOrigin = origin;
+	m_fogCloudId = nextFogCloudId++;
 	m_fogActive = true;
 	m_fogTimer = FOG_DURATION;
 	m_fogStartDist = FOG_START_INITIAL;
 	m_fogEndDist = FOG_END_INITIAL;
-
-	if (m_driver)
-		m_driver->setFog(FOG_COLOR, EFT_FOG_LINEAR, m_fogStartDist, m_fogEndDist, 0.0f, true, false);
 }
 
 void FogEnemy::updateFog(f32 deltaTime)
@@ -482,7 +479,12 @@ void FogEnemy::updateFog(f32 deltaTime)
 		m_fogStartDist = FOG_START_INITIAL + (FOG_START_FINAL - FOG_START_INITIAL) * t;
 		m_fogEndDist = FOG_END_INITIAL + (FOG_END_FINAL - FOG_END_INITIAL) * t;
 	}
+}
 
-	if (m_driver)
-		m_driver->setFog(FOG_COLOR, EFT_FOG_LINEAR, m_fogStartDist, m_fogEndDist, 0.0f, true, false);
+f32 FogEnemy::getFogStrength() const
+{
+	if (!m_fogActive)
+		return 0.0f;
+	// Full while the fog holds, then thins out with the fade
+	return m_fogFinished ? m_fogTimer / FOG_DURATION : 1.0f;
 }
@@ -24,6 +24,12 @@ public:
 
 	bool isDead() const { return m_isDead; }
 	bool isFogActive() const { return m_fogActive; }
+	f32 getFogStart() const { return m_fogStartDist; }
+	f32 getFogEnd() const { return m_fogEndDist; }
+	// Grenade impact of the current cloud; the id is unique per impact
+	const vector3df& getFogOrigin() const { return m_fogOrigin; }
+	u32 getFogCloudId() const { return m_fogCloudId; }
+	f32 getFogStrength() const;
 	void takeDamage(s32 amount);
 
 	FogEnemyState getState() const { return m_state; }
@@ -32,7 +38,7 @@ private:
 	void createPhysicsBody(const vector3df& pos);
 	void spawnGrenade();
 	void updateGrenade(f32 deltaTime);
-	void activateFog();
+	void activateFog(const vector3df& origin);
 	void updateFog(f32 deltaTime);
 
 	ISceneManager* m_smgr;
@@ -72,6 +78,8 @@ private:
 	f32 m_fogStartDist;
 	f32 m_fogEndDist;
 	bool m_fogFinished;
+	vector3df m_fogOrigin;
+	u32 m_fogCloudId;
 
 	int m_currentRepositionIndex;
 	f32 m_movementSpeed;
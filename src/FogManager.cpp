@@ -0,0 +1,108 @@
+#include "FogManager.h"
+#include "FogEnemy.h"
+
+static const SColor FOG_COLOR(255, 180, 180, 180);
+static const f32 FOG_START_CLEAR = 9999.0f;
+static const f32 FOG_END_CLEAR = 10000.0f;
+
+// Past the fog end everything is solid fog color; keep a little slack so
+// the far plane never clips what the fog still blends
+static const f32 FOG_FAR_MARGIN = 100.0f;
+
+FogManager::FogManager(IVideoDriver* driver, ICameraSceneNode* camera, f32 farValue)
+	: m_driver(driver)
+	, m_camera(camera)
+	, m_clouds(nullptr)
+	, m_farValue(farValue)
+	, m_active(false)
+	, m_fogStart(0.0f)
+	, m_fogEnd(0.0f)
+	, m_cullDistance(0.0f)
+	, m_culledCount(0)
+{
+	m_camera->setFarValue(m_farValue);
+	applyFog(FOG_START_CLEAR, FOG_END_CLEAR);
+
+	ISceneManager* smgr = m_camera->getSceneManager();
+	m_clouds = new FogCloudRenderer(FOG_COLOR, smgr->getRootSceneNode(), smgr);
+	m_clouds->drop();
+}
+
+void FogManager::update(const std::vector<FogEnemy*>& enemies, f32 deltaTime)
+{
+	m_sources.clear();
+	for (FogEnemy* f : enemies)
+	{
+		if (!f->isFogActive())
+			continue;
+		Source source = { f->getFogCloudId(), f->getFogOrigin(), f->getFogStrength(), f->getFogStart(), f->getFogEnd() };
+		m_sources.push_back(source);
+	}
+	update(m_sources, deltaTime);
+}
+
+void FogManager::update(const std::vector<Source>& sources, f32 deltaTime)
+{
+	m_culledCount = 0;
+
+	// Overlapping clouds: the densest one wins
+	bool active = false;
+	f32 start = FOG_START_CLEAR, end = FOG_END_CLEAR;
+	for (const Source& source : sources)
+	{
+		if (deltaTime > 0.0f)
+			m_clouds->feed(source.cloudId, source.origin, source.strength);
+
+		if (source.end < end)
+		{
+			active = true;
+			start = source.start;
+			end = source.end;
+		}
+	}
+	if (deltaTime > 0.0f)
+		m_clouds->update(deltaTime);
+
+	m_active = active;
+	if (start != m_fogStart || end != m_fogEnd)
+		applyFog(start, end);
+
+	const f32 cullDistance = active ? end + FOG_FAR_MARGIN : 0.0f;
+	m_cullDistance = (cullDistance < m_farValue) ? cullDistance : 0.0f;
+	const f32 farValue = isDense() ? m_cullDistance : m_farValue;
+	if (m_camera->getFarValue() != farValue)
+		m_camera->setFarValue(farValue);
+}
+
+void FogManager::setFarValue(f32 farValue)
+{
+	m_farValue = farValue;
+	if (!isDense())
+		m_camera->setFarValue(m_farValue);
+}
+
+SColor FogManager::getColor()
+{
+	return FOG_COLOR;
+}
+
+SColor FogManager::getClearColor() const
+{
+	return m_active ? FOG_COLOR : SColor(0, 0, 0, 0);
+}
+
+bool FogManager::cull(f32 distanceSQ)
+{
+	if (!isDense() || distanceSQ <= m_cullDistance * m_cullDistance)
+		return false;
+
+	m_culledCount++;
+	return true;
+}
+
+void FogManager::applyFog(f32 start, f32 end)
+{
+	m_fogStart = start;
+	m_fogEnd = end;
+	m_driver->setFog(FOG_COLOR, EFT_FOG_LINEAR, start, end, 0.0f, true, false);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <irrlicht.h>
+#include <vector>
+#include "FogCloudRenderer.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+class FogEnemy;
+
+// Single owner of the driver fog. Every FogEnemy only tracks its own cloud;
+// once per frame the densest active cloud is applied to the driver, and
+// while it is dense the camera far plane is pulled in to just past the fog
+// end. Actors further than that are fully fog colored, so callers can ask
+// cull() whether to skip them entirely. Each cloud is also drawn where its
+// grenade landed, as puffs from a shared particle renderer; the driver fog
+// stays as the far-range effect.
+class FogManager
+{
+public:
+	// One active cloud: the driver fog range it asks for and where its puffs
+	// are drawn, as a FogEnemy reports it
+	struct Source
+	{
+		u32 cloudId;
+		vector3df origin;
+		f32 strength;
+		f32 start, end;
+	};
+
+	FogManager(IVideoDriver* driver, ICameraSceneNode* camera, f32 farValue);
+
+	// deltaTime 0 freezes the cloud particles (menus, pause)
+	void update(const std::vector<FogEnemy*>& enemies, f32 deltaTime);
+	void update(const std::vector<Source>& sources, f32 deltaTime);
+
+	bool isActive() const { return m_active; }
+	bool isDense() const { return m_cullDistance > 0.0f; }
+	SColor getClearColor() const;
+	f32 getFogEnd() const { return m_fogEnd; }
+	f32 getFarValue() const { return m_camera->getFarValue(); }
+	// Far plane while there is no dense fog
+	void setFarValue(f32 farValue);
+
+	// True if something at this squared distance from the camera is hidden
+	// by the fog; counts the culled actors for this frame
+	bool cull(f32 distanceSQ);
+	u32 getCulledCount() const { return m_culledCount; }
+
+	FogCloudRenderer* getClouds() const { return m_clouds; }
+	static SColor getColor();
+
+private:
+	void applyFog(f32 start, f32 end);
+
+	IVideoDriver*     m_driver;
+	ICameraSceneNode* m_camera;
+	FogCloudRenderer* m_clouds;
+	f32  m_farValue;      // far plane without fog
+	bool m_active;
+	f32  m_fogStart;
+	f32  m_fogEnd;
+	f32  m_cullDistance;  // 0 while fog is thin or off
+	u32  m_culledCount;
+	std::vector<Source> m_sources; // scratch for the FogEnemy overload
+};
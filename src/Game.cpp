@@ -1,4 +1,5 @@
 #include "Game.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -24,47 +25,99 @@ static const s32 PICKUP_AMMO_AMOUNT = 7;
 
 static const f32 POWERUP_WORLD_LIFETIME = 15.0f;
 
+static const int REWIND_TICKS = 120; // 2 s of 1/60 s physics ticks
+
+static const f32 DEBUG_DRAW_RADIUS = 600.0f; // wireframe filter around the player (F2)
+
 static const s32 MONEY_BASIC_KILL = 30;
 static const s32 MONEY_FAST_KILL = 50;
 static const s32 MONEY_FOG_KILL = 80;
 
-Game::Game()
+static const f32 ARENA_BOUNDS_MARGIN = 200.0f;
+static const f32 ARENA_BOUNDS_MIN_Y = -200.0f;
+static const f32 ARENA_BOUNDS_MAX_Y = 800.0f;
+
+// MD2 meshes shared by several nodes; their poses are interpolated once and reused
+static const char* POSE_CACHED_MESHES[] =
+{
+	"assets/models/player/tris.md2",
+	"assets/models/enemy/tris.md2",
+	"assets/models/fog_enemy/Tris.md2",
+};
+
+static const f32 PLAYER_SHADOW_RADIUS = 20.0f;
+
+// Reduced animation LOD runs at 10 Hz; off-screen enemies don't animate
+static const f32 ANIM_LOD_REDUCED_INTERVAL = 0.1f;
+
+// Quality ladder for the governor, best first. Distances and far plane are in
+// world units; tier 0 matches the fixed settings used before the governor.
+static const QualityTier QUALITY_TIERS[] =
+{
+	// name       stencil shadows animLod impostor far               debug  full detail
+	{ L"high",    true,   true,   600.0f, 1200.0f, CAMERA_FAR_VALUE, false, 32 },
+	{ L"medium",  false,  true,   450.0f, 1000.0f, 12000.0f,         false, 8 },
+	{ L"low",     false,  true,   300.0f,  800.0f,  8000.0f,         true,  5 },
+	{ L"minimal", false,  false,  200.0f,  600.0f,  5000.0f,         true,  3 },
+};
+
+static std::vector<QualityTier> buildQualityTiers(const RenderConfig& config)
+{
+	std::vector<QualityTier> tiers(QUALITY_TIERS, QUALITY_TIERS + sizeof(QUALITY_TIERS) / sizeof(QUALITY_TIERS[0]));
+	// Stencil volumes are only used when asked for on the command line
+	if (!config.stencilShadows)
+		for (QualityTier& t : tiers)
+			t.stencilShadows = false;
+	return tiers;
+}
+
+Game::Game(const PhysicsConfig& physicsConfig, const RenderConfig& renderConfig)
 	: m_device(nullptr)
 	, m_driver(nullptr)
 	, m_smgr(nullptr)
 	, m_gui(nullptr)
+	, m_physicsConfig(physicsConfig)
+	, m_renderConfig(renderConfig)
 	, m_physics(nullptr)
 	, m_debugDrawer(nullptr)
-	, m_groundBody(nullptr)
 	, m_showDebug(false)
+	, m_debugRadiusFilter(false)
 	, m_player(nullptr)
 	, m_pickupSpawnTimer(0.0f)
 	, m_camera(nullptr)
-	, m_ground(nullptr)
-	, m_ammoText(nullptr)
-	, m_healthText(nullptr)
-	, m_timerText(nullptr)
-	, m_waveText(nullptr)
-	, m_killText(nullptr)
+	, m_hud(nullptr)
 	, m_killCount(0)
-	, m_moneyText(nullptr)
 	, m_money(0)
-	, m_powerupIcons{nullptr, nullptr, nullptr}
-	, m_powerupTimers{nullptr, nullptr, nullptr}
-	, m_powerupTextures{nullptr, nullptr, nullptr}
+	, m_powerupSprites{-1, -1, -1}
+	, m_powerupIconVisible{false, false, false}
+	, m_sprites(nullptr)
+	, m_bulletIconSprite(-1)
 	, m_state(GameState::MENU)
-	, m_menuBgTex(nullptr)
-	, m_logoTex(nullptr)
-	, m_playBtnTex(nullptr)
-	, m_customizeBtnTex(nullptr)
-	, m_exitBtnTex(nullptr)
-	, m_resumeBtnTex(nullptr)
-	, m_backBtnTex(nullptr)
-	, m_playBtnHoverTex(nullptr)
-	, m_customizeBtnHoverTex(nullptr)
-	, m_exitBtnHoverTex(nullptr)
-	, m_resumeBtnHoverTex(nullptr)
-	, m_backBtnHoverTex(nullptr)
+	, m_cameraYaw(0.0f)
+	, m_lastTime(0)
+	, m_centerX(0)
+	, m_centerY(0)
+	, m_crosshairSprite(-1)
+	, m_crosshairVisible(false)
+	, m_gameTimer(GAME_DURATION)
+	, m_spawnTimer(0.0f)
+	, m_currentWave(1)
+	, m_powerupSpawnedWave{false, false, false}
+	, m_soundEngine(nullptr)
+	, m_chasingSound(nullptr)
+	, m_clickSoundSrc(nullptr)
+	, m_menuBgSprite(-1)
+	, m_logoSprite(-1)
+	, m_playBtnSprite(-1)
+	, m_customizeBtnSprite(-1)
+	, m_exitBtnSprite(-1)
+	, m_resumeBtnSprite(-1)
+	, m_backBtnSprite(-1)
+	, m_playBtnHoverSprite(-1)
+	, m_customizeBtnHoverSprite(-1)
+	, m_exitBtnHoverSprite(-1)
+	, m_resumeBtnHoverSprite(-1)
+	, m_backBtnHoverSprite(-1)
 	, m_totalMoney(0)
 	, m_healthUpgradeLevel(0)
 	, m_damageUpgradeLevel(0)
@@ -72,25 +125,17 @@ Game::Game()
 	, m_selectedSkin(0)
 	, m_previewedSkin(0)
 	, m_skinUnlocked{true, false, false}
-	, m_skinPreview{nullptr, nullptr, nullptr}
-	, m_skinPreviewWeapon{nullptr, nullptr, nullptr}
-	, m_skinPreviewPivot{nullptr, nullptr, nullptr}
+	, m_skinPreview(nullptr)
 	, m_skinPreviewRotation(0.0f)
 	, m_skinDragging(false)
 	, m_skinDragLastX(0)
-	, m_skyBox(nullptr)
-	, m_mapNode(nullptr)
-	, m_cameraYaw(0.0f)
-	, m_lastTime(0)
-	, m_centerX(0)
-	, m_centerY(0)
-	, m_soundEngine(nullptr)
-	, m_chasingSound(nullptr)
-	, m_clickSoundSrc(nullptr)
-	, m_gameTimer(GAME_DURATION)
-	, m_spawnTimer(0.0f)
-	, m_currentWave(1)
-	, m_powerupSpawnedWave{false, false, false}
+	, m_animLod(ANIM_LOD_REDUCED_INTERVAL)
+	, m_qualityTiers(buildQualityTiers(renderConfig))
+	, m_quality(m_qualityTiers.data(), m_qualityTiers.size(), renderConfig.targetFrameTime)
+	, m_enemyStencilShadows(false)
+	, m_shadowRebuilds(0)
+	, m_shadowReuses(0)
+	, m_shadowAdjacencyBuilds(0)
 {
 	m_soundEngine = irrklang::createIrrKlangDevice();
 	if (m_soundEngine)
@@ -128,6 +173,15 @@ Game::~Game()
 	delete m_player;
 	m_player = nullptr;
 
+	delete m_hud;
+	m_hud = nullptr;
+
+	delete m_sprites;
+	m_sprites = nullptr;
+
+	delete m_skinPreview;
+	m_skinPreview = nullptr;
+
 	delete m_debugDrawer;
 	m_debugDrawer = nullptr;
 
@@ -159,16 +213,37 @@ void Game::init()
 		skin->setFont(font);
 
 	// Create physics world before scene objects
-	m_physics = new Physics();
+	f32 boundsHalf = ARENA_HALF_SIZE + ARENA_BOUNDS_MARGIN;
+	m_physicsConfig.worldMin = vector3df(-boundsHalf, ARENA_BOUNDS_MIN_Y, -boundsHalf);
+	m_physicsConfig.worldMax = vector3df(boundsHalf, ARENA_BOUNDS_MAX_Y, boundsHalf);
+	m_physics = new Physics(m_physicsConfig);
 
 	// Debug drawer for physics visualization
 	m_debugDrawer = new DebugDrawer(m_driver);
 	m_physics->setDebugDrawer(m_debugDrawer);
 
+	// Keep the last few seconds of physics ticks for rewinding in TESTING
+	m_physics->setSnapshotsEnabled(true);
+
+	// Must run before any node loads these meshes
+	for (const char* path : POSE_CACHED_MESHES)
+	{
+		MD2PoseCache* cache = MD2PoseCache::install(m_smgr, path);
+		if (cache)
+			m_poseCaches.push_back(cache);
+	}
+
 	setupScene();
+	m_arena.setupImpostors();
+
+	m_quality.setEnabled(m_renderConfig.adaptiveQuality);
+	applyQualityTier();
+
+	setupSprites();
 	setupHUD();
 
 	m_player = new Player(m_smgr, m_driver, m_physics);
+	m_arena.getBlobShadows()->addCaster(m_player->getNode(), PLAYER_SHADOW_RADIUS);
 
 	vector3df pickupPositions[] = {
 		vector3df(-400, -25, -300),
@@ -197,19 +272,6 @@ void Game::init()
 			vector3df(0, -25, 200), PowerupType::GOD_MODE));
 	}
 
-	m_menuBgTex = m_driver->getTexture("assets/textures/backgrounds/mainmenu.png");
-	m_logoTex = m_driver->getTexture("assets/textures/UI/logo.png");
-	m_playBtnTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Start/Start1.png");
-	m_customizeBtnTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Customize/Customize1.png");
-	m_exitBtnTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Quit/Quit1.png");
-	m_resumeBtnTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Resume/Resume1.png");
-	m_backBtnTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Back/Back1.png");
-
-	m_playBtnHoverTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Start/Start3.png");
-	m_customizeBtnHoverTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Customize/Customize3.png");
-	m_exitBtnHoverTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Quit/Quit3.png");
-	m_resumeBtnHoverTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Resume/Resume3.png");
-	m_backBtnHoverTex = m_driver->getTexture("assets/textures/UI/Button Itch Pack/Back/Back3.png");
 
 	{
 		static const char* skinTexPaths[3] = {
@@ -219,37 +281,11 @@ void Game::init()
 		};
 		IAnimatedMesh* previewMesh = m_smgr->getMesh("assets/models/player/tris.md2");
 		IAnimatedMesh* weaponMesh = m_smgr->getMesh("assets/models/player/weapon.md2");
+		ITexture* weaponTex = m_driver->getTexture("assets/models/player/Weapon.pcx");
 
+		m_skinPreview = new SkinPreviewRenderer(m_smgr);
 		for (int i = 0; i < 3; i++)
-		{
-			// Create a pivot node for rotation
-			m_skinPreviewPivot[i] = m_smgr->addEmptySceneNode();
-			m_skinPreviewPivot[i]->setPosition(vector3df(-5000 + i * 120, 0, 0));
-			m_skinPreviewPivot[i]->setVisible(false);
-
-			if (previewMesh)
-			{
-				m_skinPreview[i] = m_smgr->addAnimatedMeshSceneNode(previewMesh, m_skinPreviewPivot[i]);
-				if (m_skinPreview[i])
-				{
-					m_skinPreview[i]->setMaterialTexture(0, m_driver->getTexture(skinTexPaths[i]));
-					m_skinPreview[i]->setMaterialFlag(EMF_LIGHTING, false);
-					m_skinPreview[i]->setMD2Animation(EMAT_STAND);
-					m_skinPreview[i]->setPosition(vector3df(0, 0, 0));
-				}
-			}
-
-			if (weaponMesh && m_skinPreview[i])
-			{
-				m_skinPreviewWeapon[i] = m_smgr->addAnimatedMeshSceneNode(weaponMesh, m_skinPreview[i]);
-				if (m_skinPreviewWeapon[i])
-				{
-					m_skinPreviewWeapon[i]->setMaterialTexture(0, m_driver->getTexture("assets/models/player/Weapon.pcx"));
-					m_skinPreviewWeapon[i]->setMaterialFlag(EMF_LIGHTING, false);
-					m_skinPreviewWeapon[i]->setMD2Animation(EMAT_STAND);
-				}
-			}
-		}
+			m_skinPreview->addSkin(previewMesh, m_driver->getTexture(skinTexPaths[i]), weaponMesh, weaponTex);
 	}
 
 	{
@@ -284,210 +320,24 @@ void Game::init()
 	m_centerX = screenSize.Width / 2;
 	m_centerY = screenSize.Height / 2;
 	m_device->getCursorControl()->setPosition(m_centerX, m_centerY);
-
-
-	struct ObstacleData { float x, z, w, h, d; bool isPillar; };
-	static const ObstacleData obstacles[] =
-	{
-		// Pillars 
-		{  150,  250, 50, 180, 50, true },
-		{ -300,  400, 60, 210, 60, true },
-		{  500, -200, 40, 150, 40, true },
-		{ -600, -500, 70, 240, 70, true },
-		{  800,  600, 50, 165, 50, true },
-		{ -900,  100, 60, 195, 60, true },
-		{  350, -700, 40, 225, 40, true },
-		{ -200, -900, 50, 180, 50, true },
-		{ 1000, -400, 60, 210, 60, true },
-		{-1100,  700, 50, 150, 50, true },
-		{  700,  900, 70, 240, 70, true },
-		{ -500,  800, 40, 165, 40, true },
-
-		// Boxes 
-		{  250, -350, 50, 30, 40, false },
-		{ -400, -150, 60, 40, 50, false },
-		{  600,  350, 40, 25, 35, false },
-		{ -750,  500, 55, 45, 45, false },
-		{  450,  700, 45, 30, 55, false },
-		{ -300, -600, 50, 40, 40, false },
-		{  900, -100, 35, 25, 60, false },
-		{-1000, -300, 60, 45, 50, false },
-		{  200,  500, 40, 30, 40, false },
-		{ -150,  150, 55, 40, 55, false },
-		{  750, -800, 45, 25, 35, false },
-		{ -800, -700, 50, 45, 45, false },
-	};
-
-	static const float groundY = -25.0f;
-	ITexture* pillarTex = m_driver->getTexture("assets/textures/obstacles/pillar.png");
-	ITexture* boxTex = m_driver->getTexture("assets/textures/obstacles/box.jpg");
-
-	for (const auto& obs : obstacles)
-	{
-		scene::ISceneNode* node = m_smgr->addCubeSceneNode(1.0f);
-		if (node)
-		{
-			node->setScale(core::vector3df(obs.w, obs.h, obs.d));
-
-			core::vector3df pos(obs.x, groundY + obs.h / 2.0f, obs.z);
-			node->setPosition(pos);
-			node->setMaterialFlag(video::EMF_LIGHTING, false);
-			node->setMaterialFlag(video::EMF_FOG_ENABLE, true);
-			node->setMaterialTexture(0, obs.isPillar ? pillarTex : boxTex);
-
-			btBoxShape* shape = new btBoxShape(btVector3(obs.w * 0.5f, obs.h * 0.5f, obs.d * 0.5f));
-			m_physics->createRigidBody(0.0f, shape, pos);
-		}
-	}
 }
 
 void Game::setupScene()
 {
 	// Camera
 	m_camera = m_smgr->addCameraSceneNode();
-	m_camera->setFarValue(20000.0f);
-	
-	m_ground = m_smgr->addCubeSceneNode(10.0f);
-	if (m_ground)
-	{
-		m_ground->setScale(vector3df(300.0f, 0.1f, 300.0f));
-		m_ground->setPosition(vector3df(0, -25, 0));
-		m_ground->setMaterialFlag(EMF_LIGHTING, false);
-		m_ground->setMaterialFlag(EMF_FOG_ENABLE, true);
-		m_ground->setMaterialTexture(0, m_driver->getTexture("assets/textures/building/ground.jpg"));
-	}
-
-	m_skyBox = m_smgr->addSkyBoxSceneNode(
-		m_driver->getTexture("assets/textures/skybox/irrlicht2_up.jpg"),
-		m_driver->getTexture("assets/textures/skybox/irrlicht2_dn.jpg"),
-		m_driver->getTexture("assets/textures/skybox/irrlicht2_lf.jpg"),
-		m_driver->getTexture("assets/textures/skybox/irrlicht2_rt.jpg"),
-		m_driver->getTexture("assets/textures/skybox/irrlicht2_ft.jpg"),
-		m_driver->getTexture("assets/textures/skybox/irrlicht2_bk.jpg"));
-
-	btBoxShape* groundShape = new btBoxShape(btVector3(1500.0f, 0.5f, 1500.0f));
-	m_groundBody = m_physics->createRigidBody(0.0f, groundShape, vector3df(0, -25, 0));
-
-	// Arena boundary walls 
-	float wallHeight = 200.0f;
-	float wallThickness = 80.0f;
-	float halfGround = 1500.0f;
-	float wallY = -25.0f + wallHeight / 2.0f;
-
-	// +X wall at x=1500
-	btBoxShape* wallShapeX = new btBoxShape(btVector3(wallThickness / 2.0f, wallHeight / 2.0f, halfGround));
-	m_physics->createRigidBody(0.0f, wallShapeX, vector3df(halfGround - 300, wallY, 0));
-	// -X wall at x=-1500
-	m_physics->createRigidBody(0.0f, new btBoxShape(btVector3(wallThickness / 2.0f, wallHeight / 2.0f, halfGround)), vector3df(-halfGround + 50, wallY, 0));
-	// +Z wall at z=1500
-	btBoxShape* wallShapeZ = new btBoxShape(btVector3(halfGround, wallHeight / 2.0f, wallThickness / 2.0f));
-	m_physics->createRigidBody(0.0f, wallShapeZ, vector3df(0, wallY, halfGround - 300));
-	// -Z wall at z=-1500
-	m_physics->createRigidBody(0.0f, new btBoxShape(btVector3(halfGround, wallHeight / 2.0f, wallThickness / 2.0f)), vector3df(0, wallY, -halfGround + 320));
-
-	// side wall of +X wall (rotated 45 degrees)
-	btBoxShape* wallShapeSide1X = new btBoxShape(btVector3(wallThickness / 2.0f, wallHeight / 2.0f, halfGround));
-	btRigidBody* wallSide1X = m_physics->createRigidBody(0.0f, wallShapeSide1X, vector3df(halfGround - 300, wallY, -270));
-	btTransform tr;
-	wallSide1X->getMotionState()->getWorldTransform(tr);
-	tr.setRotation(btQuaternion(btVector3(0, 1, 0), 45.0f * core::DEGTORAD));
-	wallSide1X->getMotionState()->setWorldTransform(tr);
-	wallSide1X->setWorldTransform(tr);
-
-	// side wall of +X wall (rotated 45 degrees)
-	btBoxShape* wallShapeSide2X = new btBoxShape(btVector3(wallThickness / 2.0f, wallHeight / 2.0f, halfGround + 200));
-	btRigidBody* wallSide2X = m_physics->createRigidBody(0.0f, wallShapeSide2X, vector3df(halfGround - 50, wallY, 100.0f));
-	btTransform tr2;
-	wallSide2X->getMotionState()->getWorldTransform(tr2);
-	tr2.setRotation(btQuaternion(btVector3(0, 1, 0), -47.0f * core::DEGTORAD));
-	wallSide2X->getMotionState()->setWorldTransform(tr2);
-	wallSide2X->setWorldTransform(tr2);
-
-	m_smgr->addLightSceneNode(0, vector3df(0, 500, 0), SColorf(1.0f, 1.0f, 1.0f), 1500.0f);
-	m_smgr->setAmbientLight(SColorf(0.3f, 0.3f, 0.3f));
-	m_smgr->setShadowColor(video::SColor(150, 0, 0, 0));
-
-
-	m_mapNode = m_smgr->addMeshSceneNode(m_smgr->getMesh("assets/maps/colloseum/Colloseum.obj"));
-	IMeshSceneNode* map = m_mapNode;
-	map->setPosition(vector3df(-620, 180, 0));
-
-	map->setScale(vector3df(10, 11, 11));
-	map->setMaterialFlag(EMF_LIGHTING, false);
-	map->setMaterialFlag(EMF_FOG_ENABLE, true);
-
-	m_driver->setFog(SColor(255, 180, 180, 180), EFT_FOG_LINEAR, 9999.0f, 10000.0f, 0.0f, false, true);
-
-	setupGates(map);
-}
 
-void Game::setupGates(IMeshSceneNode* map)
-{
-	IMesh* gateMesh = m_smgr->getMesh("assets/maps/gate/gate.obj");
-	ITexture* pillarTex = m_driver->getTexture("assets/textures/obstacles/pillar.png");
-
-	struct GateData { vector3df position; f32 rotationY; };
-	GateData gates[] =
-	{
-		{ vector3df( -7, -25,  -5),  90.0f },  // +X edge, face inward
-		{ vector3df( 105, -25,  5), -90.0f },  // -X edge, face inward
-		{ vector3df(    0, -25, 38), 180.0f },  // +Z edge, face inward
-		{ vector3df(    0, -25,-38),   0.0f },  // -Z edge, face inward
-	};
-
-	for (const auto& g : gates)
-	{
-		IMeshSceneNode* gate = m_smgr->addMeshSceneNode(gateMesh, map);
-		gate->setPosition(g.position);
-		gate->setRotation(vector3df(0, g.rotationY, 0));
-		gate->setScale(vector3df(4, 3, 8));
-		gate->setMaterialFlag(video::EMF_LIGHTING, false);
-		gate->setMaterialFlag(video::EMF_FOG_ENABLE, true);
-
-		IMeshSceneNode* blackCube = m_smgr->addCubeSceneNode(20.0f, gate);
-		blackCube->setPosition(vector3df(2, 5.6f, -10.3f));
-		blackCube->setScale(vector3df(0.3f, 0.35f, 0.1f));
-		blackCube->setMaterialFlag(video::EMF_LIGHTING, true);
-		blackCube->setMaterialFlag(video::EMF_FOG_ENABLE, true);
-		blackCube->setMaterialType(video::EMT_SOLID);
-		blackCube->getMaterial(0).ColorMaterial = video::ECM_NONE;
-		blackCube->getMaterial(0).DiffuseColor = SColor(255, 0, 0, 0);
-		blackCube->getMaterial(0).AmbientColor = SColor(255, 0, 0, 0);
-		blackCube->getMaterial(0).EmissiveColor = SColor(255, 0, 0, 0);
-
-		IMeshSceneNode* leftCube = m_smgr->addCubeSceneNode(20.0f, gate);
-		leftCube->setPosition(vector3df(-2, 5.6f, -9.8f));
-		leftCube->setScale(vector3df(0.06f, 0.35f, 0.1f));
-		leftCube->setMaterialFlag(video::EMF_LIGHTING, false);
-		leftCube->setMaterialFlag(video::EMF_FOG_ENABLE, true);
-		leftCube->setMaterialTexture(0, pillarTex);
-
-		IMeshSceneNode* rightCube = m_smgr->addCubeSceneNode(20.0f, gate);
-		rightCube->setPosition(vector3df(5.5f, 5.6f, -9.8f));
-		rightCube->setScale(vector3df(0.06f, 0.35f, 0.1f));
-		rightCube->setMaterialFlag(video::EMF_LIGHTING, false);
-		rightCube->setMaterialFlag(video::EMF_FOG_ENABLE, true);
-		rightCube->setMaterialTexture(0, pillarTex);
-
-		vector3df mapPos = map->getPosition();
-		vector3df mapScale = map->getScale();
-		vector3df worldPos(
-			mapPos.X + g.position.X * mapScale.X,
-			0.0f,  
-			mapPos.Z + g.position.Z * mapScale.Z
-		);
-		m_gatePositions.push_back(worldPos);
-	}
+	m_arena.build(m_smgr, m_camera, CAMERA_FAR_VALUE, m_physics);
 }
 
 void Game::spawnEnemyAtGate(int gateIndex, EnemyType type)
 {
-	if (gateIndex < 0 || gateIndex >= (int)m_gatePositions.size())
+	if (gateIndex < 0 || gateIndex >= (int)m_arena.getGatePositions().size())
 		return;
 
 	static const f32 SPAWN_OFFSET = 700.0f; // how far behind the gate the enemy spawns
 
-	vector3df gatePos = m_gatePositions[gateIndex];
+	vector3df gatePos = m_arena.getGatePositions()[gateIndex];
 	vector3df forward = vector3df(0, 0, 0) - gatePos;
 	forward.Y = 0;
 	forward.normalize();
@@ -511,16 +361,18 @@ void Game::spawnEnemyAtGate(int gateIndex, EnemyType type)
 	}
 
 	m_enemies.push_back(new Enemy(m_smgr, m_driver, m_physics, spawnPos, forward, m_soundEngine, type));
+	m_enemies.back()->setSpawnGate(gateIndex);
+	addEnemyShadow(m_enemies.back()->getNode());
 }
 
 void Game::spawnFogEnemyAtGate(int gateIndex)
 {
-	if (gateIndex < 0 || gateIndex >= (int)m_gatePositions.size())
+	if (gateIndex < 0 || gateIndex >= (int)m_arena.getGatePositions().size())
 		return;
 
 	static const f32 SPAWN_OFFSET = 700.0f;
 
-	vector3df gatePos = m_gatePositions[gateIndex];
+	vector3df gatePos = m_arena.getGatePositions()[gateIndex];
 	vector3df forward = vector3df(0, 0, 0) - gatePos;
 	forward.Y = 0;
 	forward.normalize();
@@ -542,74 +394,202 @@ void Game::spawnFogEnemyAtGate(int gateIndex)
 	}
 
 	m_fogEnemies.push_back(new FogEnemy(m_smgr, m_driver, m_physics, spawnPos, forward, m_soundEngine));
+	m_fogEnemies.back()->setSpawnGate(gateIndex);
+	addEnemyShadow(m_fogEnemies.back()->getNode());
 }
 
-void Game::setupHUD()
+static IShadowVolumeSceneNode* findShadowVolume(ISceneNode* node)
 {
-	ITexture* bulletHudGui = m_driver->getTexture("assets/textures/hud/bullet_icon.png");
-	if (bulletHudGui)
-	{
-		IGUIImage* img = m_gui->addImage(bulletHudGui, position2d<s32>(m_driver->getScreenSize().Width - (m_driver->getScreenSize().Width / 7), m_driver->getScreenSize().Height - (m_driver->getScreenSize().Height / 8)));
-		img->setScaleImage(true);
-		img->setMaxSize(dimension2du(72,72));
-	}
+	for (ISceneNode* child : node->getChildren())
+		if (child->getType() == ESNT_SHADOW_VOLUME)
+			return static_cast<IShadowVolumeSceneNode*>(child);
+	return nullptr;
+}
 
-	m_ammoText = m_gui->addStaticText(
-		L"5",
-		rect<s32>(m_driver->getScreenSize().Width - (m_driver->getScreenSize().Width / 11), m_driver->getScreenSize().Height - (m_driver->getScreenSize().Height / 10), m_driver->getScreenSize().Width - (m_driver->getScreenSize().Width / 10) + 200, 900),
-		false, false, 0, -1, false
-	);
-	m_ammoText->setOverrideColor(SColor(255, 255, 255, 255));
+void Game::addEnemyShadow(ISceneNode* node)
+{
+	setEnemyShadow(node, m_enemyStencilShadows);
+}
 
-	m_healthText = m_gui->addStaticText(
-		L"HP: 100",
-		rect<s32>(m_driver->getScreenSize().Width / 22, m_driver->getScreenSize().Height - (m_driver->getScreenSize().Height / 10), 400, 900),
-		false, false, 0, -1, false
-	);
-	m_healthText->setOverrideColor(SColor(255, 255, 255, 255));
+void Game::setEnemyShadow(ISceneNode* node, bool stencil)
+{
+	if (!node)
+		return;
 
-	{
-		s32 screenW = m_driver->getScreenSize().Width;
-		m_timerText = m_gui->addStaticText(
-			L"3:00",
-			rect<s32>(screenW / 2 - 60, 30, screenW / 2 + 60, 70),
-			false, false, 0, -1, false
-		);
-		m_timerText->setOverrideColor(SColor(255, 255, 255, 255));
-	}
+	// Stencil volumes are the high quality tier: exact, but rebuilt whenever
+	// the animation pose or the light direction changes. Blob shadows cost
+	// one shared draw for all.
+	// A volume is kept hidden while the quality tier uses blobs.
+	if (node->getType() != ESNT_ANIMATED_MESH)
+		stencil = false;
+
+	ISceneNode* volume = findShadowVolume(node);
+	if (stencil && !volume)
+		volume = static_cast<IAnimatedMeshSceneNode*>(node)->addShadowVolumeSceneNode();
+	if (volume)
+		volume->setVisible(stencil);
+
+	BlobShadowRenderer* blobs = m_arena.getBlobShadows();
+	blobs->removeCaster(node);
+	if (!stencil)
+		blobs->addCaster(node, ENEMY_SHADOW_RADIUS * node->getScale().X);
+}
 
+void Game::applyQualityTier()
+{
+	const QualityTier& tier = m_quality.getTier();
+	m_arena.getFog()->setFarValue(tier.farValue);
+	m_arena.getBlobShadows()->setVisible(tier.shadows);
+
+	const bool stencil = tier.shadows && tier.stencilShadows;
+	if (stencil != m_enemyStencilShadows)
 	{
-		s32 screenW = m_driver->getScreenSize().Width;
-		m_waveText = m_gui->addStaticText(
-			L"Wave 1",
-			rect<s32>(screenW / 2 - 60, 80, screenW / 2 + 60, 115),
-			false, false, 0, -1, false
-		);
-		m_waveText->setOverrideColor(SColor(255, 255, 200, 0));
+		m_enemyStencilShadows = stencil;
+		for (Enemy* e : m_enemies)
+			setEnemyShadow(e->getNode(), stencil);
+		for (FogEnemy* f : m_fogEnemies)
+			setEnemyShadow(f->getNode(), stencil);
 	}
+}
 
-	{
-		s32 screenW = m_driver->getScreenSize().Width;
-		m_killText = m_gui->addStaticText(
-			L"Kills: 0",
-			rect<s32>(screenW - 250, 30, screenW - 10, 80),
-			false, false, 0, -1, false
-		);
-		m_killText->setOverrideColor(SColor(255, 255, 255, 255));
+void Game::updateActorLod(f32 deltaTime)
+{
+	m_animLod.beginFrame();
+	if (ImpostorRenderer* impostors = m_arena.getImpostors())
+		impostors->clear();
+	const vector3df cameraPos = m_camera->getAbsolutePosition();
+	m_arena.getGatePortals().update(m_camera);
+
+	// Volumes are updated while rendering, so these are last frame's
+	io::IAttributes* params = m_smgr->getParameters();
+	m_shadowRebuilds = params->getAttributeAsInt(SHADOW_VOLUME_REBUILDS);
+	m_shadowReuses = params->getAttributeAsInt(SHADOW_VOLUME_REUSES);
+	m_shadowAdjacencyBuilds += params->getAttributeAsInt(SHADOW_VOLUME_ADJACENCY_BUILDS);
+	params->setAttribute(SHADOW_VOLUME_REBUILDS, 0);
+	params->setAttribute(SHADOW_VOLUME_REUSES, 0);
+	params->setAttribute(SHADOW_VOLUME_ADJACENCY_BUILDS, 0);
+
+	m_lodActors.clear();
+	auto addActor = [&](GameObject* actor, s32 skin, bool dead)
+	{
+		ISceneNode* node = actor->getNode();
+		if (!node || node->getType() != ESNT_ANIMATED_MESH)
+			return;
+		LodActor a = { actor, skin, dead, node->getAbsolutePosition().getDistanceFromSQ(cameraPos) };
+		m_lodActors.push_back(a);
+	};
+	for (Enemy* e : m_enemies)
+		addActor(e, m_arena.getImpostorSkin(e->getType() == EnemyType::FAST ? ArenaScene::SKIN_FAST : ArenaScene::SKIN_BASIC), e->isDead());
+	for (FogEnemy* f : m_fogEnemies)
+		addActor(f, m_arena.getImpostorSkin(ArenaScene::SKIN_FOG_ENEMY), f->isDead());
+
+	// Nearest first, so the tier's full-detail budget goes to the closest enemies
+	std::sort(m_lodActors.begin(), m_lodActors.end(),
+		[](const LodActor& a, const LodActor& b) { return a.distSQ < b.distSQ; });
+
+	u32 fullDetailCount = 0;
+	for (const LodActor& a : m_lodActors)
+		updateActorLod(a, fullDetailCount, deltaTime);
+}
+
+void Game::updateActorLod(const LodActor& a, u32& fullDetailCount, f32 deltaTime)
+{
+	const QualityTier& tier = m_quality.getTier();
+	GameObject* actor = a.actor;
+	const bool dead = a.dead;
+	const f32 distSQ = a.distSQ;
+	IAnimatedMeshSceneNode* animNode = static_cast<IAnimatedMeshSceneNode*>(actor->getNode());
+
+	// Still in a spawn tunnel behind the wall: only seen through its gate
+	s32 gate = actor->getSpawnGate();
+	bool portalCulled = !dead && m_arena.getGatePortals().cull(gate, animNode->getAbsolutePosition());
+	actor->setSpawnGate(gate);
+	actor->setPortalCulled(portalCulled);
+
+	// Behind dense fog the actor would be drawn in solid fog color
+	bool fogCulled = !dead && !portalCulled && m_arena.getFog()->cull(distSQ);
+	actor->setFogCulled(fogCulled);
+
+	// Dying actors go back to the full mesh so the death animation is visible.
+	// An impostor has no blob shadow: the hidden node is skipped as a caster.
+	ImpostorRenderer* impostors = m_arena.getImpostors();
+	bool impostor = impostors && !dead && !portalCulled && !fogCulled && a.skin >= 0 && distSQ > tier.impostorDistance * tier.impostorDistance;
+	actor->setImpostor(impostor);
+	if (impostor)
+		impostors->add(animNode, a.skin);
+
+	// Death always plays at full rate; removal itself runs on the actor's timer
+	AnimationLod::Level level = AnimationLod::FULL;
+	if (!dead)
+	{
+		if (portalCulled || fogCulled || m_smgr->isCulled(animNode))
+			level = AnimationLod::FROZEN;
+		else if (distSQ > tier.animLodDistance * tier.animLodDistance || fullDetailCount >= tier.maxFullDetailEnemies)
+			level = AnimationLod::REDUCED;
+		else
+			fullDetailCount++;
 	}
+	m_animLod.update(animNode, actor->getAnimLod(), level, deltaTime);
+}
+
+void Game::setupSprites()
+{
+	// Every 2D image goes into the atlas up front, so menus and HUD share pages
+	m_sprites = new SpriteBatch(m_driver);
+	m_menuBgSprite = m_sprites->add("assets/textures/backgrounds/mainmenu.png");
+	m_logoSprite = m_sprites->add("assets/textures/UI/logo.png");
+	m_playBtnSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Start/Start1.png");
+	m_customizeBtnSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Customize/Customize1.png");
+	m_exitBtnSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Quit/Quit1.png");
+	m_resumeBtnSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Resume/Resume1.png");
+	m_backBtnSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Back/Back1.png");
+
+	m_playBtnHoverSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Start/Start3.png");
+	m_customizeBtnHoverSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Customize/Customize3.png");
+	m_exitBtnHoverSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Quit/Quit3.png");
+	m_resumeBtnHoverSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Resume/Resume3.png");
+	m_backBtnHoverSprite = m_sprites->add("assets/textures/UI/Button Itch Pack/Back/Back3.png");
+
+	m_bulletIconSprite = m_sprites->add("assets/textures/hud/bullet_icon.png");
+	m_crosshairSprite = m_sprites->add("assets/textures/hud/crosshair.png");
+	m_powerupSprites[0] = m_sprites->add("assets/textures/powerups/speed_boost.png");
+	m_powerupSprites[1] = m_sprites->add("assets/textures/powerups/damage_boost.png");
+	m_powerupSprites[2] = m_sprites->add("assets/textures/powerups/GOD_mode.png");
+
+	m_sprites->build();
+}
+
+// Same rect an IGUIImage with setScaleImage(true) and setMaxSize(maxSize) covers
+static rect<s32> getIconRect(const dimension2du& size, s32 x, s32 y, u32 maxSize)
+{
+	return rect<s32>(x, y, x + core::min_(size.Width, maxSize), y + core::min_(size.Height, maxSize));
+}
+
+void Game::setupHUD()
+{
+	m_bulletIconRect = getIconRect(m_sprites->getSize(m_bulletIconSprite),
+		m_driver->getScreenSize().Width - (m_driver->getScreenSize().Width / 7),
+		m_driver->getScreenSize().Height - (m_driver->getScreenSize().Height / 8), 72);
+
+	// Text labels are retained and only reformatted when their value changes
+	m_hud = new Hud(m_sprites, m_gui->getSkin()->getFont());
+
+	m_hud->setLayout(Hud::AMMO,
+		rect<s32>(m_driver->getScreenSize().Width - (m_driver->getScreenSize().Width / 11), m_driver->getScreenSize().Height - (m_driver->getScreenSize().Height / 10), m_driver->getScreenSize().Width - (m_driver->getScreenSize().Width / 10) + 200, 900),
+		SColor(255, 255, 255, 255));
+
+	m_hud->setLayout(Hud::HEALTH,
+		rect<s32>(m_driver->getScreenSize().Width / 22, m_driver->getScreenSize().Height - (m_driver->getScreenSize().Height / 10), 400, 900),
+		SColor(255, 255, 255, 255));
 
 	{
 		s32 screenW = m_driver->getScreenSize().Width;
-		m_moneyText = m_gui->addStaticText(
-			L"$0",
-			rect<s32>(screenW - 250, 80, screenW - 10, 120),
-			false, false, 0, -1, false
-		);
-		m_moneyText->setOverrideColor(SColor(255, 255, 215, 0));
+		m_hud->setLayout(Hud::TIMER, rect<s32>(screenW / 2 - 60, 30, screenW / 2 + 60, 70), SColor(255, 255, 255, 255));
+		m_hud->setLayout(Hud::WAVE, rect<s32>(screenW / 2 - 60, 80, screenW / 2 + 60, 115), SColor(255, 255, 200, 0));
+		m_hud->setLayout(Hud::KILLS, rect<s32>(screenW - 250, 30, screenW - 10, 80), SColor(255, 255, 255, 255));
+		m_hud->setLayout(Hud::MONEY, rect<s32>(screenW - 250, 80, screenW - 10, 120), SColor(255, 255, 215, 0));
 	}
 
-	ITexture* crosshairTex = m_driver->getTexture("assets/textures/hud/crosshair.png");
-	if (crosshairTex)
 	{
 		dimension2d<u32> screenSize = m_driver->getScreenSize();
 		s32 screenCX = screenSize.Width / 2;
@@ -617,9 +597,7 @@ void Game::setupHUD()
 		s32 crosshairSize = 70;
 		s32 cx = screenCX - crosshairSize / 2;
 		s32 cy = screenCY - crosshairSize / 2;
-		crosshair = m_gui->addImage(crosshairTex, position2d<s32>(cx, cy));
-		crosshair->setScaleImage(true);
-		crosshair->setMaxSize(dimension2du(crosshairSize, crosshairSize));
+		m_crosshairRect = getIconRect(m_sprites->getSize(m_crosshairSprite), cx, cy, crosshairSize);
 	}
 
 	// Powerup HUD icons + timers (left side, below HP)
@@ -629,33 +607,15 @@ void Game::setupHUD()
 		s32 iconSize = 32;
 		s32 spacing = -40;
 
-		const char* texPaths[3] = {
-			"assets/textures/powerups/speed_boost.png",
-			"assets/textures/powerups/damage_boost.png",
-			"assets/textures/powerups/GOD_mode.png"
-		};
-
 		for (int i = 0; i < 3; i++)
 		{
-			m_powerupTextures[i] = m_driver->getTexture(texPaths[i]);
 			s32 y = baseY + i * spacing;
+			m_powerupIconRects[i] = getIconRect(m_sprites->getSize(m_powerupSprites[i]), baseX, y, iconSize);
 
-			m_powerupIcons[i] = nullptr;
-			if (m_powerupTextures[i])
-			{
-				m_powerupIcons[i] = m_gui->addImage(m_powerupTextures[i], position2d<s32>(baseX, y));
-				m_powerupIcons[i]->setScaleImage(true);
-				m_powerupIcons[i]->setMaxSize(dimension2du(iconSize, iconSize));
-				m_powerupIcons[i]->setVisible(false);
-			}
-
-			m_powerupTimers[i] = m_gui->addStaticText(
-				L"",
+			m_hud->setLayout((Hud::Label)(Hud::POWERUP_TIMER_0 + i),
 				rect<s32>(baseX + iconSize + 8, y + 4, baseX + iconSize + 108, y + 34),
-				false, false, 0, -1, false
-			);
-			m_powerupTimers[i]->setOverrideColor(SColor(255, 255, 255, 255));
-			m_powerupTimers[i]->setVisible(false);
+				SColor(255, 255, 255, 255));
+			m_hud->setPowerupTimer(i, false, 0.0f);
 		}
 	}
 }
@@ -678,8 +638,13 @@ void Game::run()
 		u32 currentTime = m_device->getTimer()->getTime();
 		f32 deltaTime = (currentTime - m_lastTime) / 1000.0f;
 		m_lastTime = currentTime;
+		const f32 frameTime = deltaTime; // unclamped, for the quality governor
 		if (deltaTime > 0.1f) deltaTime = 0.1f;
 
+		// Slow the whole simulation down instead of letting physics fall behind
+		if (m_state == GameState::PLAYING || m_state == GameState::TESTING)
+			deltaTime = m_physics->budgetFrameTime(deltaTime);
+
 		// Update based on state
 		switch (m_state)
 		{
@@ -708,21 +673,29 @@ void Game::run()
 
 		if (m_input.consumeKeyPress(KEY_F1))
 			m_showDebug = !m_showDebug;
+		if (m_input.consumeKeyPress(KEY_F2))
+			m_debugRadiusFilter = !m_debugRadiusFilter;
 
-		// Render
-		SColor clearColor(0, 0, 0, 0);
-		bool fogActive = false;
-		for (FogEnemy* f : m_fogEnemies)
+		// Quality tiers only follow in-game frames; menus restart the measurement
+		if (m_state == GameState::PLAYING || m_state == GameState::TESTING)
 		{
-			if (f->isFogActive())
-			{
-				clearColor = SColor(255, 180, 180, 180);
-				fogActive = true;
-				break;
-			}
+			if (m_quality.update(frameTime))
+				applyQualityTier();
+		}
+		else
+		{
+			m_quality.reset();
 		}
-		m_smgr->setShadowColor(fogActive ? SColor(0, 0, 0, 0) : SColor(150, 0, 0, 0));
-		m_driver->beginScene(true, true, clearColor);
+
+		const bool inGame = m_state == GameState::PLAYING || m_state == GameState::TESTING;
+		m_arena.getFog()->update(m_fogEnemies, inGame ? deltaTime : 0.0f);
+		if (inGame)
+			updateActorLod(deltaTime);
+
+		// Render
+		m_smgr->setShadowColor(m_arena.getFog()->isActive() ? SColor(0, 0, 0, 0) : SColor(150, 0, 0, 0));
+		m_driver->beginScene(true, true, m_arena.getFog()->getClearColor());
+		m_sprites->beginFrame();
 
 		if (m_state == GameState::MENU)
 		{
@@ -730,11 +703,12 @@ void Game::run()
 		}
 		else if (m_state == GameState::CUSTOMIZE)
 		{
-			// Gray background, then render 3D model preview on top
+			// Gray background, then the cached model preview on top
 			dimension2d<u32> scr = m_driver->getScreenSize();
-			m_driver->draw2DRectangle(SColor(255, 50, 50, 50),
+			m_sprites->drawRect(SColor(255, 50, 50, 50),
 				rect<s32>(0, 0, scr.Width, scr.Height));
-			m_smgr->drawAll();
+			m_sprites->flush();
+			m_skinPreview->draw();
 			drawCustomize();
 		}
 		else
@@ -744,8 +718,11 @@ void Game::run()
 
 			if (m_showDebug)
 			{
+				const bool nearPlayer = m_debugRadiusFilter || m_quality.getTier().debugNearPlayerOnly;
+				m_debugDrawer->setFilter(m_player->getPosition(), nearPlayer ? DEBUG_DRAW_RADIUS : 0.0f);
 				m_debugDrawer->beginDraw();
 				m_physics->debugDrawWorld();
+				m_debugDrawer->endDraw();
 
 				const auto& ray = m_player->getDebugRay();
 				if (ray.active)
@@ -758,8 +735,12 @@ void Game::run()
 				}
 			}
 
+			drawHUDSprites();
 			m_gui->drawAll();
 
+			if (m_showDebug)
+				drawDebugStats();
+
 			if (m_state == GameState::PAUSED)
 				drawPause();
 			else if (m_state == GameState::GAMEOVER)
@@ -768,6 +749,7 @@ void Game::run()
 				drawWin();
 		}
 
+		m_sprites->flush();
 		m_driver->endScene();
 	}
 }
@@ -852,7 +834,7 @@ void Game::updatePlaying(f32 deltaTime)
 			else
 				type = canFast ? EnemyType::FAST : EnemyType::BASIC;
 
-			int gateIndex = rand() % (int)m_gatePositions.size();
+			int gateIndex = rand() % (int)m_arena.getGatePositions().size();
 			spawnEnemyAtGate(gateIndex, type);
 			m_spawnTimer = spawnInterval;
 		}
@@ -876,7 +858,7 @@ void Game::updatePlaying(f32 deltaTime)
 		}
 		if (!fogAlive)
 		{
-			int gateIndex = rand() % (int)m_gatePositions.size();
+			int gateIndex = rand() % (int)m_arena.getGatePositions().size();
 			spawnFogEnemyAtGate(gateIndex);
 		}
 	}
@@ -1151,12 +1133,7 @@ void Game::updatePlaying(f32 deltaTime)
 		return;
 	}
 
-	if (crosshair)
-	{
-		bool showCrosshair = m_input.isRightMouseDown();
-
-		crosshair->setVisible(showCrosshair);
-	}
+	m_crosshairVisible = m_input.isRightMouseDown();
 }
 
 void Game::updateTesting(f32 deltaTime)
@@ -1189,6 +1166,9 @@ void Game::updateTesting(f32 deltaTime)
 	if (m_input.consumeKeyPress(KEY_KEY_8)) spawnEnemyAtGate(3, EnemyType::FAST);
 	if (m_input.consumeKeyPress(KEY_KEY_0)) spawnFogEnemyAtGate(rand() % 4);
 
+	// R: rewind physics state (player, enemies, triggers) by two seconds
+	if (m_input.consumeKeyPress(KEY_KEY_R)) m_physics->rewind(REWIND_TICKS);
+
 	// Player input (movement + shooting)
 	m_player->handleInput(deltaTime, m_input, m_cameraYaw);
 
@@ -1376,11 +1356,7 @@ void Game::updateTesting(f32 deltaTime)
 	updateCamera();
 	updateHUD();
 
-	if (crosshair)
-	{
-		bool showCrosshair = m_input.isRightMouseDown();
-		crosshair->setVisible(showCrosshair);
-	}
+	m_crosshairVisible = m_input.isRightMouseDown();
 }
 
 void Game::updateGameOver(f32 deltaTime)
@@ -1422,43 +1398,23 @@ void Game::updateCamera()
 
 void Game::updateHUD()
 {
-	wchar_t ammoStr[16];
-	swprintf(ammoStr, 16, L"%d", m_player->getAmmo());
-	m_ammoText->setText(ammoStr);
-
-	wchar_t hpStr[32];
-	swprintf(hpStr, 32, L"HP: %d", m_player->getHealth());
-	m_healthText->setText(hpStr);
+	m_hud->setAmmo(m_player->getAmmo());
+	m_hud->setHealth(m_player->getHealth());
 
 	// Timer display (MM:SS)
-	s32 totalSeconds = (s32)ceilf(m_gameTimer);
-	if (totalSeconds < 0) totalSeconds = 0;
-	s32 minutes = totalSeconds / 60;
-	s32 seconds = totalSeconds % 60;
-	wchar_t timerStr[16];
-	swprintf(timerStr, 16, L"%d:%02d", minutes, seconds);
-	m_timerText->setText(timerStr);
+	m_hud->setTimer((s32)ceilf(m_gameTimer));
 
 	// Wave display
-	wchar_t waveStr[16];
-	swprintf(waveStr, 16, L"Wave %d", m_currentWave);
-	m_waveText->setText(waveStr);
+	m_hud->setWave(m_currentWave);
 	if (m_currentWave == 1)
-		m_waveText->setOverrideColor(SColor(255, 0, 255, 0));
+		m_hud->setColor(Hud::WAVE, SColor(255, 0, 255, 0));
 	else if (m_currentWave == 2)
-		m_waveText->setOverrideColor(SColor(255, 255, 255, 0));
+		m_hud->setColor(Hud::WAVE, SColor(255, 255, 255, 0));
 	else
-		m_waveText->setOverrideColor(SColor(255, 255, 0, 0));
-
-	// Kill count
-	wchar_t killStr[32];
-	swprintf(killStr, 32, L"Kills: %d", m_killCount);
-	m_killText->setText(killStr);
+		m_hud->setColor(Hud::WAVE, SColor(255, 255, 0, 0));
 
-	// Money
-	wchar_t moneyStr[32];
-	swprintf(moneyStr, 32, L"$%d", m_money);
-	m_moneyText->setText(moneyStr);
+	m_hud->setKills(m_killCount);
+	m_hud->setMoney(m_money);
 
 	// Powerup HUD indicators
 	bool active[3] = { m_player->hasSpeedBoost(), m_player->hasDamageBoost(), m_player->hasGodMode() };
@@ -1466,17 +1422,8 @@ void Game::updateHUD()
 
 	for (int i = 0; i < 3; i++)
 	{
-		if (m_powerupIcons[i]) m_powerupIcons[i]->setVisible(active[i]);
-		if (m_powerupTimers[i])
-		{
-			m_powerupTimers[i]->setVisible(active[i]);
-			if (active[i])
-			{
-				wchar_t buf[16];
-				swprintf(buf, 16, L"%.1fs", timers[i]);
-				m_powerupTimers[i]->setText(buf);
-			}
-		}
+		m_powerupIconVisible[i] = active[i];
+		m_hud->setPowerupTimer(i, active[i], timers[i]);
 	}
 }
 
@@ -1498,35 +1445,46 @@ bool Game::isCursorInRect(const rect<s32>& r) const
 	return r.isPointInside(cursor);
 }
 
-void Game::drawButton(ITexture* tex, ITexture* hoverTex, const rect<s32>& btnRect)
+void Game::drawButton(s32 sprite, s32 hoverSprite, const rect<s32>& btnRect)
 {
-	ITexture* t = (hoverTex && isCursorInRect(btnRect)) ? hoverTex : tex;
-	if (t)
-	{
-		dimension2d<u32> ts = t->getOriginalSize();
-		m_driver->draw2DImage(t, btnRect,
-			rect<s32>(0, 0, ts.Width, ts.Height), 0, 0, true);
-	}
+	m_sprites->draw((hoverSprite >= 0 && isCursorInRect(btnRect)) ? hoverSprite : sprite, btnRect);
+}
+
+void Game::drawHUDSprites()
+{
+	m_sprites->draw(m_bulletIconSprite, m_bulletIconRect);
+	if (m_crosshairVisible)
+		m_sprites->draw(m_crosshairSprite, m_crosshairRect);
+	for (int i = 0; i < 3; i++)
+		if (m_powerupIconVisible[i])
+			m_sprites->draw(m_powerupSprites[i], m_powerupIconRects[i]);
+	m_hud->draw();
+	m_sprites->flush();
 }
 
 void Game::setHUDVisible(bool visible)
 {
-	if (m_ammoText) m_ammoText->setVisible(visible);
-	if (m_healthText) m_healthText->setVisible(visible);
-	if (m_timerText) m_timerText->setVisible(visible);
-	if (m_waveText) m_waveText->setVisible(visible);
-	if (m_killText) m_killText->setVisible(visible);
-	if (m_moneyText) m_moneyText->setVisible(visible);
-	if (crosshair) crosshair->setVisible(false); // crosshair managed separately
+	if (m_hud) m_hud->setVisible(visible);
+	m_crosshairVisible = false; // crosshair managed separately
 	for (int i = 0; i < 3; i++)
 	{
-		if (m_powerupIcons[i]) m_powerupIcons[i]->setVisible(false);
-		if (m_powerupTimers[i]) m_powerupTimers[i]->setVisible(false);
+		m_powerupIconVisible[i] = false;
+		if (m_hud) m_hud->setPowerupTimer(i, false, 0.0f);
 	}
 }
 
 void Game::resetGame()
 {
+	for (MD2PoseCache* cache : m_poseCaches)
+		cache->resetStats();
+	m_shadowAdjacencyBuilds = 0;
+
+	if (m_arena.getFog())
+		m_arena.getFog()->getClouds()->clear();
+
+	if (m_arena.getImpostors())
+		m_arena.getImpostors()->clear();
+
 	for (Enemy* e : m_enemies) delete e;
 	m_enemies.clear();
 
@@ -1544,6 +1502,9 @@ void Game::resetGame()
 
 	m_player->reset(m_healthUpgradeLevel);
 
+	// Drop snapshot history from the previous run
+	m_physics->setSnapshotsEnabled(true);
+
 	m_gameTimer = GAME_DURATION;
 	m_spawnTimer = 0.0f;
 	m_currentWave = 1;
@@ -1586,19 +1547,11 @@ void Game::updateMenu()
 				while (m_device->run() && (m_device->getTimer()->getTime() - startMs) < 2000)
 				{
 					m_driver->beginScene(true, true, SColor(0, 0, 0, 0));
-					if (m_menuBgTex)
-					{
-						dimension2d<u32> ts = m_menuBgTex->getOriginalSize();
-						m_driver->draw2DImage(m_menuBgTex, rect<s32>(0, 0, ss.Width, ss.Height),
-							rect<s32>(0, 0, ts.Width, ts.Height));
-					}
-					IGUIFont* font = m_gui->getSkin()->getFont();
-					if (font)
-					{
-						font->draw(L"Loading...",
-							rect<s32>(ss.Width - 300, ss.Height - 60, ss.Width - 30, ss.Height - 20),
-							SColor(255, 255, 255, 255), false, false);
-					}
+					m_sprites->draw(m_menuBgSprite, rect<s32>(0, 0, ss.Width, ss.Height));
+					m_sprites->drawText(m_gui->getSkin()->getFont(), L"Loading...",
+						rect<s32>(ss.Width - 300, ss.Height - 60, ss.Width - 30, ss.Height - 20),
+						SColor(255, 255, 255, 255));
+					m_sprites->flush();
 					m_driver->endScene();
 				}
 			}
@@ -1621,20 +1574,8 @@ void Game::updateMenu()
 			m_skinPreviewRotation = 0.0f;
 			m_previewedSkin = m_selectedSkin;
 			m_lastTime = m_device->getTimer()->getTime();
-			// Hide scene nodes so only gray background + model preview show
-			if (m_skyBox) m_skyBox->setVisible(false);
-			if (m_mapNode) m_mapNode->setVisible(false);
-			if (m_ground) m_ground->setVisible(false);
-			// Show only the previewed skin's model
-			for (int i = 0; i < 3; i++)
-			{
-				if (m_skinPreviewPivot[i])
-					m_skinPreviewPivot[i]->setVisible(i == m_previewedSkin);
-			}
-			// Position camera to look at the previewed model
-			f32 modelX = -5000 + m_previewedSkin * 120;
-			m_camera->setPosition(vector3df(modelX, 40, -150));
-			m_camera->setTarget(vector3df(modelX, 20, 0));
+			m_skinPreview->setSkin(m_previewedSkin);
+			m_skinPreview->resetRenderCount();
 		}
 		else if (isClickInRect(m_exitBtnRect))
 		{
@@ -1704,24 +1645,15 @@ void Game::updateCustomize()
 	if (m_skinPreviewRotation > 360.0f) m_skinPreviewRotation -= 360.0f;
 	if (m_skinPreviewRotation < 0.0f) m_skinPreviewRotation += 360.0f;
 
-	if (m_skinPreviewPivot[m_previewedSkin])
-		m_skinPreviewPivot[m_previewedSkin]->setRotation(vector3df(0, m_skinPreviewRotation, 0));
+	m_skinPreview->setRotation(m_skinPreviewRotation);
 
-	auto hidePreviewsAndGoMenu = [this]() {
-		for (int i = 0; i < 3; i++)
-		{
-			if (m_skinPreviewPivot[i])
-				m_skinPreviewPivot[i]->setVisible(false);
-		}
-		if (m_skyBox) m_skyBox->setVisible(true);
-		if (m_mapNode) m_mapNode->setVisible(true);
-		if (m_ground) m_ground->setVisible(true);
+	auto backToMenu = [this]() {
 		m_state = GameState::MENU;
 	};
 
 	if (m_input.consumeKeyPress(KEY_ESCAPE))
 	{
-		hidePreviewsAndGoMenu();
+		backToMenu();
 		return;
 	}
 
@@ -1730,7 +1662,7 @@ void Game::updateCustomize()
 		if (isClickInRect(m_custBackBtnRect))
 		{
 			playClickSound();
-			hidePreviewsAndGoMenu();
+			backToMenu();
 			return;
 		}
 
@@ -1772,19 +1704,8 @@ void Game::updateCustomize()
 			if (isClickInRect(m_custSkinPreviewBtnRects[i]) && i != m_previewedSkin)
 			{
 				playClickSound();
-				// Hide old preview, show new one
-				if (m_skinPreviewPivot[m_previewedSkin])
-					m_skinPreviewPivot[m_previewedSkin]->setVisible(false);
 				m_previewedSkin = i;
-				if (m_skinPreviewPivot[i])
-				{
-					m_skinPreviewPivot[i]->setVisible(true);
-					m_skinPreviewPivot[i]->setRotation(vector3df(0, m_skinPreviewRotation, 0));
-				}
-				// Move camera to look at the new model
-				f32 modelX = -5000 + i * 120;
-				m_camera->setPosition(vector3df(modelX, 40, -150));
-				m_camera->setTarget(vector3df(modelX, 20, 0));
+				m_skinPreview->setSkin(i);
 			}
 		}
 
@@ -1821,36 +1742,24 @@ void Game::drawMenu()
 {
 	dimension2d<u32> ss = m_driver->getScreenSize();
 
-	if (m_menuBgTex)
-	{
-		dimension2d<u32> texSize = m_menuBgTex->getOriginalSize();
-		m_driver->draw2DImage(m_menuBgTex,
-			rect<s32>(0, 0, ss.Width, ss.Height),
-			rect<s32>(0, 0, texSize.Width, texSize.Height));
-	}
-
-	if (m_logoTex)
-	{
-		dimension2d<u32> ts = m_logoTex->getOriginalSize();
-		m_driver->draw2DImage(m_logoTex, m_logoRect,
-			rect<s32>(0, 0, ts.Width, ts.Height), 0, 0, true);
-	}
+	m_sprites->draw(m_menuBgSprite, rect<s32>(0, 0, ss.Width, ss.Height));
+	m_sprites->draw(m_logoSprite, m_logoRect);
 
-	drawButton(m_playBtnTex, m_playBtnHoverTex, m_playBtnRect);
-	drawButton(m_customizeBtnTex, m_customizeBtnHoverTex, m_customizeBtnRect);
-	drawButton(m_exitBtnTex, m_exitBtnHoverTex, m_exitBtnRect);
+	drawButton(m_playBtnSprite, m_playBtnHoverSprite, m_playBtnRect);
+	drawButton(m_customizeBtnSprite, m_customizeBtnHoverSprite, m_customizeBtnRect);
+	drawButton(m_exitBtnSprite, m_exitBtnHoverSprite, m_exitBtnRect);
 }
 
 void Game::drawPause()
 {
 	dimension2d<u32> ss = m_driver->getScreenSize();
 
-	m_driver->draw2DRectangle(SColor(150, 0, 0, 0),
+	m_sprites->drawRect(SColor(150, 0, 0, 0),
 		rect<s32>(0, 0, ss.Width, ss.Height));
 
-	drawButton(m_resumeBtnTex, m_resumeBtnHoverTex, m_resumeBtnRect);
+	drawButton(m_resumeBtnSprite, m_resumeBtnHoverSprite, m_resumeBtnRect);
 
-	drawButton(m_exitBtnTex, m_exitBtnHoverTex, m_pauseExitBtnRect);
+	drawButton(m_exitBtnSprite, m_exitBtnHoverSprite, m_pauseExitBtnRect);
 }
 
 s32 Game::getUpgradeCost(s32 level) const
@@ -1866,12 +1775,12 @@ void Game::drawCustomize()
 	IGUIFont* font = m_gui->getSkin()->getFont();
 	if (!font) return;
 
-	font->draw(L"CUSTOMIZE", rect<s32>(0, 30, ss.Width, 70),
+	m_sprites->drawText(font, L"CUSTOMIZE", rect<s32>(0, 30, ss.Width, 70),
 		SColor(255, 255, 255, 255), true, true);
 
 	wchar_t moneyStr[64];
 	swprintf(moneyStr, 64, L"Money: $%d", m_totalMoney);
-	font->draw(moneyStr, rect<s32>(0, 75, ss.Width, 110),
+	m_sprites->drawText(font, moneyStr, rect<s32>(0, 75, ss.Width, 110),
 		SColor(255, 255, 215, 0), true, true);
 
 	s32 rowW = 900, rowH = 55, rowSpacing = 16;
@@ -1888,13 +1797,13 @@ void Game::drawCustomize()
 		// Left side: dark background with label text
 		s32 labelW = rowW - btnW - 10; // 10px gap between label and button
 		rect<s32> labelRect(rowX, y, rowX + labelW, y + rowH);
-		m_driver->draw2DRectangle(SColor(180, 40, 40, 40), labelRect);
+		m_sprites->drawRect(SColor(180, 40, 40, 40), labelRect);
 
 		// Draw level pips
 		wchar_t levelStr[128];
 		swprintf(levelStr, 128, L"%s  Lv.%d / %d  (%s)", name, level, maxLevel, bonus);
 		SColor labelColor = maxed ? SColor(255, 150, 150, 150) : SColor(255, 255, 255, 255);
-		font->draw(levelStr, rect<s32>(rowX + 10, y, rowX + labelW, y + rowH), labelColor, false, true);
+		m_sprites->drawText(font, levelStr, rect<s32>(rowX + 10, y, rowX + labelW, y + rowH), labelColor, false, true);
 
 		// Right side: upgrade button
 		s32 btnX = rowX + rowW - btnW;
@@ -1922,19 +1831,19 @@ void Game::drawCustomize()
 			btnTextColor = SColor(255, 255, 80, 80);
 		}
 
-		m_driver->draw2DRectangle(btnBg, btnRect);
+		m_sprites->drawRect(btnBg, btnRect);
 
 		// Button border
-		m_driver->draw2DRectangle(SColor(255, 180, 180, 180),
+		m_sprites->drawRect(SColor(255, 180, 180, 180),
 			rect<s32>(btnX, y, btnX + btnW, y + 1));
-		m_driver->draw2DRectangle(SColor(255, 180, 180, 180),
+		m_sprites->drawRect(SColor(255, 180, 180, 180),
 			rect<s32>(btnX, y + rowH - 1, btnX + btnW, y + rowH));
-		m_driver->draw2DRectangle(SColor(255, 180, 180, 180),
+		m_sprites->drawRect(SColor(255, 180, 180, 180),
 			rect<s32>(btnX, y, btnX + 1, y + rowH));
-		m_driver->draw2DRectangle(SColor(255, 180, 180, 180),
+		m_sprites->drawRect(SColor(255, 180, 180, 180),
 			rect<s32>(btnX + btnW - 1, y, btnX + btnW, y + rowH));
 
-		font->draw(btnText, btnRect, btnTextColor, true, true);
+		m_sprites->drawText(font, btnText, btnRect, btnTextColor, true, true);
 	};
 
 	drawUpgradeRow(L"Health", L"+25 HP", m_healthUpgradeLevel, 5, m_custHealthBtnRect, startY);
@@ -1962,21 +1871,21 @@ void Game::drawCustomize()
 		else
 			bgColor = SColor(200, 60, 60, 60);  
 
-		m_driver->draw2DRectangle(bgColor, m_custSkinPreviewBtnRects[i]);
+		m_sprites->drawRect(bgColor, m_custSkinPreviewBtnRects[i]);
 
 		if (m_previewedSkin == i)
 		{
-			m_driver->draw2DRectangle(SColor(255, 0, 200, 255),
+			m_sprites->drawRect(SColor(255, 0, 200, 255),
 				rect<s32>(rowX - 2, by - 2, rowX + skinBtnW + 2, by));
-			m_driver->draw2DRectangle(SColor(255, 0, 200, 255),
+			m_sprites->drawRect(SColor(255, 0, 200, 255),
 				rect<s32>(rowX - 2, by + skinBtnH, rowX + skinBtnW + 2, by + skinBtnH + 2));
-			m_driver->draw2DRectangle(SColor(255, 0, 200, 255),
+			m_sprites->drawRect(SColor(255, 0, 200, 255),
 				rect<s32>(rowX - 2, by, rowX, by + skinBtnH));
-			m_driver->draw2DRectangle(SColor(255, 0, 200, 255),
+			m_sprites->drawRect(SColor(255, 0, 200, 255),
 				rect<s32>(rowX + skinBtnW, by, rowX + skinBtnW + 2, by + skinBtnH));
 		}
 
-		font->draw(skinNames[i], m_custSkinPreviewBtnRects[i],
+		m_sprites->drawText(font, skinNames[i], m_custSkinPreviewBtnRects[i],
 			SColor(255, 255, 255, 255), true, true);
 	}
 
@@ -2011,18 +1920,18 @@ void Game::drawCustomize()
 			swprintf(btnText, 64, L"$%d", skinPrices[i]);
 		}
 
-		m_driver->draw2DRectangle(bgColor, m_custSkinSelectBtnRects[i]);
+		m_sprites->drawRect(bgColor, m_custSkinSelectBtnRects[i]);
 
-		m_driver->draw2DRectangle(SColor(255, 200, 200, 200),
+		m_sprites->drawRect(SColor(255, 200, 200, 200),
 			rect<s32>(selectBtnX, selectBtnY, selectBtnX + selectBtnW, selectBtnY + 1));
-		m_driver->draw2DRectangle(SColor(255, 200, 200, 200),
+		m_sprites->drawRect(SColor(255, 200, 200, 200),
 			rect<s32>(selectBtnX, selectBtnY + selectBtnH - 1, selectBtnX + selectBtnW, selectBtnY + selectBtnH));
-		m_driver->draw2DRectangle(SColor(255, 200, 200, 200),
+		m_sprites->drawRect(SColor(255, 200, 200, 200),
 			rect<s32>(selectBtnX, selectBtnY, selectBtnX + 1, selectBtnY + selectBtnH));
-		m_driver->draw2DRectangle(SColor(255, 200, 200, 200),
+		m_sprites->drawRect(SColor(255, 200, 200, 200),
 			rect<s32>(selectBtnX + selectBtnW - 1, selectBtnY, selectBtnX + selectBtnW, selectBtnY + selectBtnH));
 
-		font->draw(btnText, m_custSkinSelectBtnRects[i],
+		m_sprites->drawText(font, btnText, m_custSkinSelectBtnRects[i],
 			SColor(255, 255, 255, 255), true, true);
 	}
 
@@ -2031,59 +1940,208 @@ void Game::drawCustomize()
 	s32 backY = ss.Height - backH - 10;
 	m_custBackBtnRect = rect<s32>(cx - backW/2, backY, cx + backW/2, backY + backH);
 
-	drawButton(m_backBtnTex, m_backBtnHoverTex, m_custBackBtnRect);
+	drawButton(m_backBtnSprite, m_backBtnHoverSprite, m_custBackBtnRect);
+}
+
+void Game::drawDebugStats()
+{
+	IGUIFont* font = m_gui->getBuiltInFont();
+	if (!font)
+		return;
+
+	const PhysicsStats& ps = m_physics->getStats();
+	wchar_t line[128];
+	s32 y = 10;
+
+	swprintf(line, 128, L"FPS: %d", m_driver->getFPS());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	swprintf(line, 128, L"Physics: %d substeps (cap %d), %.2f ms, %.3f ms/substep",
+		ps.subSteps, ps.maxSubSteps, ps.stepMs, ps.msPerSubStep);
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	if (ps.degraded)
+	{
+		swprintf(line, 128, L"Physics over budget: time x%.2f", ps.timeScale);
+		font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 80, 80));
+		y += 14;
+	}
+
+	if (const ChunkedMeshSceneNode* map = m_arena.getMap())
+	{
+		const ChunkedMeshSceneNode::CullStats& cs = map->getCullStats();
+		swprintf(line, 128, L"Map: %u / %u triangles, %u / %u chunks",
+			cs.trianglesSubmitted, cs.trianglesTotal, cs.chunksVisible, cs.chunksTotal);
+		font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+		y += 14;
+
+		swprintf(line, 128, L"Map LOD: %u / %u / %u chunks at LOD 0/1/2, %u of %u triangles, error < %.1f px",
+			cs.chunksAtLod[0], cs.chunksAtLod[1], cs.chunksAtLod[2], cs.trianglesSubmitted,
+			cs.trianglesFullDetail, map->getLodErrorThreshold());
+		font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+		y += 14;
+	}
+
+	const StaticBatch& batch = m_arena.getStaticBatch();
+	swprintf(line, 128, L"Static batch: %u draw calls (%u unbatched)",
+		batch.getDrawCallsAfter(), batch.getDrawCallsBefore());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	if (const BlobShadowRenderer* blobs = m_arena.getBlobShadows())
+	{
+		swprintf(line, 128, L"Blob shadows: %u of %u casters in 1 draw%ls", blobs->getDrawnCount(),
+			blobs->getCasterCount(), !blobs->isVisible() ? L" (off)" : m_enemyStencilShadows ? L" (enemies: stencil)" : L"");
+		font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+		y += 14;
+	}
+
+	if (m_enemyStencilShadows)
+	{
+		swprintf(line, 128, L"Shadow volumes: %u rebuilt, %u reused, %u adjacency builds",
+			m_shadowRebuilds, m_shadowReuses, m_shadowAdjacencyBuilds);
+		font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+		y += 14;
+	}
+
+	u32 poseHits = 0, poseMisses = 0, poses = 0;
+	for (MD2PoseCache* cache : m_poseCaches)
+	{
+		poseHits += cache->getHits();
+		poseMisses += cache->getMisses();
+		poses += cache->getPoseCount();
+	}
+	swprintf(line, 128, L"MD2 pose cache: %u poses, %.1f%% hits (%u interpolated)", poses,
+		(poseHits + poseMisses) ? 100.0f * poseHits / (poseHits + poseMisses) : 0.0f, poseMisses);
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	if (const ImpostorRenderer* impostors = m_arena.getImpostors())
+	{
+		swprintf(line, 128, L"Impostors: %u of %u enemies in 1 draw%ls", impostors->getInstanceCount(),
+			(u32)(m_enemies.size() + m_fogEnemies.size()), impostors->isAvailable() ? L"" : L" (no RTT)");
+		font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+		y += 14;
+	}
+
+	swprintf(line, 128, L"Animation LOD: %u full, %u at %.0f Hz, %u frozen", m_animLod.getCount(AnimationLod::FULL),
+		m_animLod.getCount(AnimationLod::REDUCED), 1.0f / m_animLod.getReducedInterval(),
+		m_animLod.getCount(AnimationLod::FROZEN));
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	swprintf(line, 128, L"2D: %u quads, %u texture binds (%u atlas pages)", m_sprites->getQuadCount(),
+		m_sprites->getTextureBinds(), m_sprites->getPageCount());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	swprintf(line, 128, L"HUD: %u labels reformatted", m_hud->getFormatCount());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	swprintf(line, 128, L"Skin preview: %u re-renders", m_skinPreview->getRenderCount());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	swprintf(line, 128, L"Physics lines: %u in %u draws (F2: %ls)", m_debugDrawer->getLineCount(),
+		m_debugDrawer->getDrawCallCount(), m_debugRadiusFilter ? L"near player"
+		: m_quality.getTier().debugNearPlayerOnly ? L"near player, quality tier" : L"all");
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	const FogManager* fog = m_arena.getFog();
+	if (fog->isDense())
+		swprintf(line, 128, L"Fog: end %.0f, far plane %.0f, %u enemies culled",
+			fog->getFogEnd(), fog->getFarValue(), fog->getCulledCount());
+	else
+		swprintf(line, 128, L"Fog: %ls, far plane %.0f", fog->isActive() ? L"thin" : L"off", fog->getFarValue());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	const FogCloudRenderer* clouds = fog->getClouds();
+	swprintf(line, 128, L"Fog clouds: %u clouds, %u of %u particles in 1 draw", clouds->getCloudCount(),
+		clouds->getParticleCount(), clouds->getCapacity());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	const QualityTier& tier = m_quality.getTier();
+	swprintf(line, 128, L"Quality: %ls (tier %u of %u), %.1f ms avg, target %.1f ms%ls", tier.name,
+		m_quality.getTierIndex() + 1, m_quality.getTierCount(), m_quality.getAverageFrameTime() * 1000.0f,
+		m_quality.getTargetFrameTime() * 1000.0f, m_quality.isEnabled() ? L"" : L" (fixed)");
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	if (m_quality.getChangeCount() > 0)
+	{
+		wchar_t change[96];
+		m_quality.describeLastChange(change, 96);
+		swprintf(line, 128, L"  last change at %.1f ms: %ls", m_quality.getChangeFrameTime() * 1000.0f, change);
+		font->draw(line, rect<s32>(10, y, 900, y + 14), SColor(255, 255, 255, 0));
+		y += 14;
+	}
+
+	const GatePortals& portals = m_arena.getGatePortals();
+	swprintf(line, 128, L"Gate portals: %u of %u openings in view, %u enemies culled in tunnels",
+		portals.getVisibleCount(), portals.getCount(), portals.getCulledCount());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
+	y += 14;
+
+	swprintf(line, 128, L"Frame: %u primitives", m_driver->getPrimitiveCountDrawn());
+	font->draw(line, rect<s32>(10, y, 600, y + 14), SColor(255, 255, 255, 0));
 }
 
 void Game::drawGameOver()
 {
 	dimension2d<u32> ss = m_driver->getScreenSize();
 
-	m_driver->draw2DRectangle(SColor(180, 0, 0, 0),
+	m_sprites->drawRect(SColor(180, 0, 0, 0),
 		rect<s32>(0, 0, ss.Width, ss.Height));
 
 	IGUIFont* font = m_gui->getSkin()->getFont();
 	if (font)
 	{
-		font->draw(L"GAME OVER", rect<s32>(0, ss.Height/2 - 80, ss.Width, ss.Height/2 - 40),
+		m_sprites->drawText(font, L"GAME OVER", rect<s32>(0, ss.Height/2 - 80, ss.Width, ss.Height/2 - 40),
 			SColor(255, 255, 50, 50), true, true);
 
 		wchar_t killStr[64];
 		swprintf(killStr, 64, L"Kills: %d", m_killCount);
-		font->draw(killStr, rect<s32>(0, ss.Height/2 - 20, ss.Width, ss.Height/2 + 20),
+		m_sprites->drawText(font, killStr, rect<s32>(0, ss.Height/2 - 20, ss.Width, ss.Height/2 + 20),
 			SColor(255, 255, 255, 255), true, true);
 
 		wchar_t moneyStr[64];
 		swprintf(moneyStr, 64, L"Earned: $%d", m_money);
-		font->draw(moneyStr, rect<s32>(0, ss.Height/2 + 20, ss.Width, ss.Height/2 + 60),
+		m_sprites->drawText(font, moneyStr, rect<s32>(0, ss.Height/2 + 20, ss.Width, ss.Height/2 + 60),
 			SColor(255, 255, 215, 0), true, true);
 	}
 
-	drawButton(m_exitBtnTex, m_exitBtnHoverTex, m_endScreenExitBtnRect);
+	drawButton(m_exitBtnSprite, m_exitBtnHoverSprite, m_endScreenExitBtnRect);
 }
 
 void Game::drawWin()
 {
 	dimension2d<u32> ss = m_driver->getScreenSize();
 
-	m_driver->draw2DRectangle(SColor(180, 0, 0, 0),
+	m_sprites->drawRect(SColor(180, 0, 0, 0),
 		rect<s32>(0, 0, ss.Width, ss.Height));
 
 	IGUIFont* font = m_gui->getSkin()->getFont();
 	if (font)
 	{
-		font->draw(L"YOU SURVIVED!", rect<s32>(0, ss.Height/2 - 80, ss.Width, ss.Height/2 - 40),
+		m_sprites->drawText(font, L"YOU SURVIVED!", rect<s32>(0, ss.Height/2 - 80, ss.Width, ss.Height/2 - 40),
 			SColor(255, 50, 255, 50), true, true);
 
 		wchar_t killStr[64];
 		swprintf(killStr, 64, L"Kills: %d", m_killCount);
-		font->draw(killStr, rect<s32>(0, ss.Height/2 - 20, ss.Width, ss.Height/2 + 20),
+		m_sprites->drawText(font, killStr, rect<s32>(0, ss.Height/2 - 20, ss.Width, ss.Height/2 + 20),
 			SColor(255, 255, 255, 255), true, true);
 
 		wchar_t moneyStr[64];
 		swprintf(moneyStr, 64, L"Earned: $%d", m_money);
-		font->draw(moneyStr, rect<s32>(0, ss.Height/2 + 20, ss.Width, ss.Height/2 + 60),
+		m_sprites->drawText(font, moneyStr, rect<s32>(0, ss.Height/2 + 20, ss.Width, ss.Height/2 + 60),
 			SColor(255, 255, 215, 0), true, true);
 	}
 
-	drawButton(m_exitBtnTex, m_exitBtnHoverTex, m_endScreenExitBtnRect);
+	drawButton(m_exitBtnSprite, m_exitBtnHoverSprite, m_endScreenExitBtnRect);
 }
@@ -10,6 +10,12 @@
 #include "Pickup.h"
 #include "Powerup.h"
 #include "DebugDrawer.h"
+#include "ArenaScene.h"
+#include "MD2PoseCache.h"
+#include "SpriteBatch.h"
+#include "Hud.h"
+#include "SkinPreviewRenderer.h"
+#include "QualityGovernor.h"
 
 using namespace irr;
 using namespace core;
@@ -19,18 +25,41 @@ using namespace gui;
 
 enum class GameState { MENU, PLAYING, TESTING, PAUSED, CUSTOMIZE, GAMEOVER, WIN };
 
+struct RenderConfig
+{
+	// Enemies cast stencil shadow volumes instead of the shared blob shadows
+	bool stencilShadows = false;
+
+	// Quality tiers are walked to hold this frame time; off keeps the top tier
+	bool adaptiveQuality = true;
+	f32 targetFrameTime = 1.0f / 60.0f;
+};
+
 class Game
 {
 public:
-	Game();
+	Game(const PhysicsConfig& physicsConfig = PhysicsConfig(), const RenderConfig& renderConfig = RenderConfig());
 	~Game();
 	void run();
 
 private:
 	void init();
 	void setupScene();
-	void setupGates(IMeshSceneNode* map);
+	void setupSprites();
 	void setupHUD();
+	void addEnemyShadow(ISceneNode* node);
+	void setEnemyShadow(ISceneNode* node, bool stencil);
+	void applyQualityTier();
+	void updateActorLod(f32 deltaTime);
+
+	struct LodActor
+	{
+		GameObject* actor;
+		s32 skin;
+		bool dead;
+		f32 distSQ; // to the camera
+	};
+	void updateActorLod(const LodActor& a, u32& fullDetailCount, f32 deltaTime);
 
 	void resetGame();
 	void updateMenu();
@@ -51,11 +80,13 @@ private:
 	void drawCustomize();
 	void drawGameOver();
 	void drawWin();
+	void drawDebugStats();
 
 	bool isClickInRect(const rect<s32>& r) const;
 	bool isCursorInRect(const rect<s32>& r) const;
 	void playClickSound();
-	void drawButton(ITexture* tex, ITexture* hoverTex, const rect<s32>& btnRect);
+	void drawButton(s32 sprite, s32 hoverSprite, const rect<s32>& btnRect);
+	void drawHUDSprites();
 
 	// Irrlicht core
 	IrrlichtDevice*    m_device;
@@ -65,10 +96,12 @@ private:
 	InputHandler       m_input;
 
 	// Physics
+	PhysicsConfig      m_physicsConfig;
+	RenderConfig       m_renderConfig;
 	Physics*           m_physics;
 	DebugDrawer*       m_debugDrawer;
-	btRigidBody*       m_groundBody;
 	bool               m_showDebug;
+	bool               m_debugRadiusFilter; // wireframe only around the player
 
 	// Game objects
 	Player*            m_player;
@@ -78,22 +111,21 @@ private:
 	std::vector<Powerup*> m_powerups;
 	f32                m_pickupSpawnTimer;
 	ICameraSceneNode*  m_camera;
-	ISceneNode*        m_ground;
 
 	// HUD
-	IGUIStaticText*    m_ammoText;
-	IGUIStaticText*    m_healthText;
-	IGUIStaticText*    m_timerText;
-	IGUIStaticText*    m_waveText;
-	IGUIStaticText*    m_killText;
+	Hud*               m_hud;
 	s32                m_killCount;
-	IGUIStaticText*    m_moneyText;
 	s32                m_money;
 
 	// Powerup HUD
-	IGUIImage*         m_powerupIcons[3];
-	IGUIStaticText*    m_powerupTimers[3];
-	ITexture*          m_powerupTextures[3];
+	s32                m_powerupSprites[3];
+	rect<s32>          m_powerupIconRects[3];
+	bool               m_powerupIconVisible[3];
+
+	// Menu, button and HUD images, drawn through one atlas
+	SpriteBatch*       m_sprites;
+	s32                m_bulletIconSprite;
+	rect<s32>          m_bulletIconRect;
 
 	// State
 	GameState          m_state;
@@ -102,7 +134,9 @@ private:
 	s32                m_centerX;
 	s32                m_centerY;
 
-	IGUIImage* crosshair = nullptr;
+	s32 m_crosshairSprite;
+	rect<s32> m_crosshairRect;
+	bool m_crosshairVisible;
 
 	// Wave system
 	f32 m_gameTimer;
@@ -115,29 +149,26 @@ private:
 	// Global attack cooldown (only one enemy attacks at a time)
 	f32 m_attackCooldown = 0.0f;
 
-	// Gate spawn positions (for enemy spawning)
-	std::vector<vector3df> m_gatePositions;
-
 	// Enemy audio
 	irrklang::ISoundEngine* m_soundEngine;
 	irrklang::ISound*       m_chasingSound;
 	irrklang::ISoundSource* m_clickSoundSrc;
 
 	// Menu textures
-	ITexture* m_menuBgTex;
-	ITexture* m_logoTex;
-	ITexture* m_playBtnTex;
-	ITexture* m_customizeBtnTex;
-	ITexture* m_exitBtnTex;
-	ITexture* m_resumeBtnTex;
-	ITexture* m_backBtnTex;
+	s32 m_menuBgSprite;
+	s32 m_logoSprite;
+	s32 m_playBtnSprite;
+	s32 m_customizeBtnSprite;
+	s32 m_exitBtnSprite;
+	s32 m_resumeBtnSprite;
+	s32 m_backBtnSprite;
 
 	// Hover textures
-	ITexture* m_playBtnHoverTex;
-	ITexture* m_customizeBtnHoverTex;
-	ITexture* m_exitBtnHoverTex;
-	ITexture* m_resumeBtnHoverTex;
-	ITexture* m_backBtnHoverTex;
+	s32 m_playBtnHoverSprite;
+	s32 m_customizeBtnHoverSprite;
+	s32 m_exitBtnHoverSprite;
+	s32 m_resumeBtnHoverSprite;
+	s32 m_backBtnHoverSprite;
 
 	// Logo + Button rects (screen space)
 	rect<s32> m_logoRect;
@@ -164,15 +195,23 @@ private:
 	rect<s32> m_custBackBtnRect;
 	s32 getUpgradeCost(s32 level) const;
 
-	// Skin preview models
-	IAnimatedMeshSceneNode* m_skinPreview[3];
-	IAnimatedMeshSceneNode* m_skinPreviewWeapon[3];
-	ISceneNode* m_skinPreviewPivot[3]; // parent nodes for rotation
+	// Skin preview models, in their own scene
+	SkinPreviewRenderer* m_skinPreview;
 	f32 m_skinPreviewRotation;
 	bool m_skinDragging;
 	s32 m_skinDragLastX;
 
-	// Scene nodes to hide during customize
-	ISceneNode* m_skyBox;
-	IMeshSceneNode* m_mapNode;
+	// Arena scene: sky, map and static geometry with the shared renderers,
+	// plus the per-frame LOD state for actors (shadows, impostors, animation, fog)
+	ArenaScene m_arena;
+	std::vector<MD2PoseCache*> m_poseCaches; // owned by the mesh cache
+	AnimationLod m_animLod;
+	std::vector<LodActor> m_lodActors; // per-frame scratch, nearest first
+
+	std::vector<QualityTier> m_qualityTiers;
+	QualityGovernor m_quality;
+	bool m_enemyStencilShadows; // current shadow type of enemies
+	u32 m_shadowRebuilds;       // stencil volumes rebuilt last frame
+	u32 m_shadowReuses;         // stencil volumes reused last frame
+	u32 m_shadowAdjacencyBuilds; // since the game started
 };
@@ -5,6 +5,10 @@ GameObject::GameObject(ISceneNode* node, btRigidBody* body)
 	, m_body(body)
 	, m_alive(true)
 	, m_removeMe(false)
+	, m_impostor(false)
+	, m_fogCulled(false)
+	, m_portalCulled(false)
+	, m_spawnGate(-1)
 {
 	if (m_body)
 		m_body->setUserPointer(this);
@@ -14,6 +18,41 @@ GameObject::~GameObject()
 {
 }
 
+void GameObject::setImpostor(bool impostor)
+{
+	if (impostor == m_impostor)
+		return;
+
+	m_impostor = impostor;
+	updateNodeVisibility();
+}
+
+void GameObject::setFogCulled(bool culled)
+{
+	if (culled == m_fogCulled)
+		return;
+
+	m_fogCulled = culled;
+	updateNodeVisibility();
+}
+
+void GameObject::setPortalCulled(bool culled)
+{
+	if (culled == m_portalCulled)
+		return;
+
+	m_portalCulled = culled;
+	updateNodeVisibility();
+}
+
+void GameObject::updateNodeVisibility()
+{
+	// Only called when one of the flags flips, so actors that hide their own
+	// node (a finished death) are left alone otherwise
+	if (m_node)
+		m_node->setVisible(!m_impostor && !m_fogCulled && !m_portalCulled);
+}
+
 void GameObject::syncPhysicsToNode()
 {
 	if (!m_body || !m_node)
@@ -2,6 +2,7 @@
 #include <irrlicht.h>
 #include <btBulletDynamicsCommon.h>
 #include "Physics.h"
+#include "AnimationLod.h"
 
 using namespace irr;
 using namespace core;
@@ -30,10 +31,33 @@ public:
 	bool shouldRemove() const { return m_removeMe; }
 	void markForRemoval() { m_removeMe = true; }
 
+	// Far away actors are drawn by an ImpostorRenderer and actors behind dense
+	// fog or in a spawn tunnel whose gate is out of view not at all; in all
+	// cases their own node is hidden
+	bool isImpostor() const { return m_impostor; }
+	void setImpostor(bool impostor);
+	bool isFogCulled() const { return m_fogCulled; }
+	void setFogCulled(bool culled);
+	bool isPortalCulled() const { return m_portalCulled; }
+	void setPortalCulled(bool culled);
+
+	// Gate whose tunnel the actor spawned in, -1 once it is inside the arena
+	s32 getSpawnGate() const { return m_spawnGate; }
+	void setSpawnGate(s32 gate) { m_spawnGate = gate; }
+
+	AnimationLod::State& getAnimLod() { return m_animLod; }
+
 protected:
+	void updateNodeVisibility();
+
 	ISceneNode*  m_node;
 	btRigidBody* m_body;
 
 	bool m_alive;
 	bool m_removeMe;
+	bool m_impostor;
+	bool m_fogCulled;
+	bool m_portalCulled;
+	s32  m_spawnGate;
+	AnimationLod::State m_animLod;
 };
@@ -0,0 +1,68 @@
+#include "GatePortals.h"
+
+GatePortals::GatePortals()
+	: m_visibleCount(0)
+	, m_culledCount(0)
+{
+}
+
+void GatePortals::add(const aabbox3df& opening, const vector3df& inward)
+{
+	Portal portal;
+	portal.opening = opening;
+	portal.plane.setPlane(opening.getCenter(), vector3df(inward).normalize());
+	portal.visible = true;
+	m_portals.push_back(portal);
+}
+
+void GatePortals::update(ICameraSceneNode* camera)
+{
+	m_visibleCount = 0;
+	m_culledCount = 0;
+
+	const SViewFrustum* frustum = camera->getViewFrustum();
+	const vector3df cameraPos = camera->getAbsolutePosition();
+	for (u32 i = 0; i < m_portals.size(); i++)
+	{
+		Portal& portal = m_portals[i];
+
+		// A camera behind the gate plane may look straight down the tunnel
+		bool visible = portal.plane.classifyPointRelation(cameraPos) != ISREL3D_FRONT;
+
+		// Frustum planes face outwards: fully in front of one means outside
+		if (!visible)
+		{
+			visible = true;
+			for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; p++)
+			{
+				if (portal.opening.classifyPlaneRelation(frustum->planes[p]) == ISREL3D_FRONT)
+				{
+					visible = false;
+					break;
+				}
+			}
+		}
+
+		portal.visible = visible;
+		if (visible)
+			m_visibleCount++;
+	}
+}
+
+bool GatePortals::cull(s32& gate, const vector3df& pos)
+{
+	if (gate < 0 || gate >= (s32)m_portals.size())
+		return false;
+
+	const Portal& portal = m_portals[gate];
+	if (portal.plane.classifyPointRelation(pos) == ISREL3D_FRONT)
+	{
+		gate = -1; // inside the arena for good
+		return false;
+	}
+	if (portal.visible)
+		return false;
+
+	m_culledCount++;
+	return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+// Gate openings as portals into the spawn tunnels. Enemies spawn behind the
+// Colosseum wall and walk in through a gate; while an actor is still behind
+// its gate's plane the wall hides it, so it can only be seen through that
+// opening. Once per frame update() tests each opening against the camera
+// frustum, and cull() tells whether an actor in a tunnel can be skipped.
+class GatePortals
+{
+public:
+	GatePortals();
+
+	// World space box around the opening and the direction into the arena
+	void add(const aabbox3df& opening, const vector3df& inward);
+	u32 getCount() const { return m_portals.size(); }
+
+	void update(ICameraSceneNode* camera);
+
+	// True if an actor at pos in the tunnel of gate can't be seen. Sets gate
+	// to -1 once the actor has crossed into the arena; counts culled actors.
+	bool cull(s32& gate, const vector3df& pos);
+
+	u32 getVisibleCount() const { return m_visibleCount; }
+	u32 getCulledCount() const { return m_culledCount; }
+
+private:
+	struct Portal
+	{
+		aabbox3df opening;
+		plane3df plane;   // through the opening, normal into the arena
+		bool visible;
+	};
+
+	array<Portal> m_portals;
+	u32 m_visibleCount;
+	u32 m_culledCount;
+};
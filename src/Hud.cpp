@@ -0,0 +1,163 @@
+#include "Hud.h"
+#include <climits>
+#include <cmath>
+#include <cwchar>
+
+static const s32 NO_VALUE = INT_MIN; // never shown yet
+
+Hud::Hud(SpriteBatch* sprites, IGUIFont* font)
+	: m_sprites(sprites)
+	, m_font(font)
+	, m_bitmapFont(nullptr)
+	, m_visible(false)
+	, m_formatCount(0)
+{
+	for (u32 i = 0; i < LABEL_COUNT; i++)
+	{
+		Field& f = m_fields[i];
+		f.value = NO_VALUE;
+		f.shown = true;
+		f.dirty = false;
+		f.color = SColor(255, 255, 255, 255);
+		f.text[0] = 0;
+	}
+
+	// Image fonts keep their glyphs in a sprite bank; hand its textures to the
+	// sprite batch so glyph quads go into the same queue as the HUD icons
+	if (m_font && m_font->getType() == EGFT_BITMAP)
+	{
+		m_bitmapFont = static_cast<IGUIFontBitmap*>(m_font);
+		IGUISpriteBank* bank = m_bitmapFont->getSpriteBank();
+		for (u32 i = 0; bank && i < bank->getTextureCount(); i++)
+			m_fontPages.push_back(m_sprites->addPage(bank->getTexture(i)));
+		if (!bank || m_fontPages.empty())
+			m_bitmapFont = nullptr;
+	}
+}
+
+void Hud::setLayout(Label label, const rect<s32>& position, SColor color)
+{
+	Field& f = m_fields[label];
+	f.position = position;
+	f.color = color;
+	f.dirty = f.value != NO_VALUE;
+}
+
+void Hud::setColor(Label label, SColor color)
+{
+	// Glyph quads take the color at draw time; no relayout needed
+	m_fields[label].color = color;
+}
+
+void Hud::setValue(Label label, s32 value)
+{
+	Field& f = m_fields[label];
+	if (f.value == value)
+		return;
+	f.value = value;
+	f.dirty = true;
+}
+
+void Hud::setAmmo(s32 ammo) { setValue(AMMO, ammo); }
+void Hud::setHealth(s32 health) { setValue(HEALTH, health); }
+void Hud::setTimer(s32 seconds) { setValue(TIMER, core::max_(seconds, 0)); }
+void Hud::setWave(s32 wave) { setValue(WAVE, wave); }
+void Hud::setKills(s32 kills) { setValue(KILLS, kills); }
+void Hud::setMoney(s32 money) { setValue(MONEY, money); }
+
+void Hud::setPowerupTimer(u32 slot, bool active, f32 seconds)
+{
+	const Label label = (Label)(POWERUP_TIMER_0 + slot);
+	m_fields[label].shown = active;
+	// Shown with one decimal, so only a new tenth of a second reformats
+	if (active)
+		setValue(label, (s32)floorf(seconds * 10.0f + 0.5f));
+}
+
+void Hud::format(Label label)
+{
+	Field& f = m_fields[label];
+	switch (label)
+	{
+	case AMMO:   swprintf(f.text, 32, L"%d", f.value); break;
+	case HEALTH: swprintf(f.text, 32, L"HP: %d", f.value); break;
+	case TIMER:  swprintf(f.text, 32, L"%d:%02d", f.value / 60, f.value % 60); break;
+	case WAVE:   swprintf(f.text, 32, L"Wave %d", f.value); break;
+	case KILLS:  swprintf(f.text, 32, L"Kills: %d", f.value); break;
+	case MONEY:  swprintf(f.text, 32, L"$%d", f.value); break;
+	default:     swprintf(f.text, 32, L"%d.%ds", f.value / 10, f.value % 10); break;
+	}
+
+	if (m_bitmapFont)
+		layout(f);
+	f.dirty = false;
+	m_formatCount++;
+}
+
+void Hud::layout(Field& field)
+{
+	// Reuses the glyph array's storage, so relayouts stop allocating once a
+	// label has been at its longest
+	field.glyphs.set_used(0);
+
+	IGUISpriteBank* bank = m_bitmapFont->getSpriteBank();
+	const array<SGUISprite>& sprites = bank->getSprites();
+	const array<rect<s32> >& positions = bank->getPositions();
+
+	// Same placement as CGUIFont::draw for image fonts, which have no under-
+	// or overhang: each glyph advances by its own dimension
+	s32 x = field.position.UpperLeftCorner.X;
+	const s32 y = field.position.UpperLeftCorner.Y;
+	wchar_t single[2] = { 0, 0 };
+	for (const wchar_t* c = field.text; *c; c++)
+	{
+		single[0] = *c;
+		const s32 advance = m_bitmapFont->getDimension(single).Width;
+
+		const u32 spriteNo = m_bitmapFont->getSpriteNoFromChar(c);
+		if (*c != L' ' && spriteNo < sprites.size() && !sprites[spriteNo].Frames.empty())
+		{
+			const SGUISpriteFrame& frame = sprites[spriteNo].Frames[0];
+			ITexture* texture = bank->getTexture(frame.textureNumber);
+			if (texture && frame.textureNumber < m_fontPages.size() && frame.rectNumber < positions.size())
+			{
+				const rect<s32>& source = positions[frame.rectNumber];
+				const dimension2du& size = texture->getOriginalSize();
+
+				Glyph glyph;
+				glyph.page = m_fontPages[frame.textureNumber];
+				glyph.dest = rect<s32>(x, y, x + source.getWidth(), y + source.getHeight());
+				glyph.uv = rect<f32>((f32)source.UpperLeftCorner.X / size.Width, (f32)source.UpperLeftCorner.Y / size.Height,
+					(f32)source.LowerRightCorner.X / size.Width, (f32)source.LowerRightCorner.Y / size.Height);
+				field.glyphs.push_back(glyph);
+			}
+		}
+		x += advance;
+	}
+}
+
+void Hud::draw()
+{
+	m_formatCount = 0;
+	if (!m_visible)
+		return;
+
+	for (u32 i = 0; i < LABEL_COUNT; i++)
+	{
+		Field& f = m_fields[i];
+		if (!f.shown || f.value == NO_VALUE)
+			continue;
+		if (f.dirty)
+			format((Label)i);
+
+		if (m_bitmapFont)
+		{
+			for (u32 g = 0; g < f.glyphs.size(); g++)
+				m_sprites->drawImage(f.glyphs[g].page, f.glyphs[g].dest, f.glyphs[g].uv, f.color);
+		}
+		else
+		{
+			m_sprites->drawText(m_font, f.text, f.position, f.color);
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <irrlicht.h>
+#include "SpriteBatch.h"
+
+using namespace irr;
+using namespace core;
+using namespace video;
+using namespace gui;
+
+// Retained in-game HUD text. Game pushes typed values every frame; a label
+// is only reformatted when its value actually changed, and the formatted
+// text is turned into a cached run of glyph quads from the bitmap font,
+// which draw() replays through the sprite batch. In steady state nothing is
+// formatted or allocated. Fonts that are not bitmap fonts fall back to
+// queuing the text on the sprite batch.
+class Hud
+{
+public:
+	enum Label
+	{
+		AMMO, HEALTH, TIMER, WAVE, KILLS, MONEY,
+		POWERUP_TIMER_0, POWERUP_TIMER_1, POWERUP_TIMER_2,
+		LABEL_COUNT
+	};
+
+	Hud(SpriteBatch* sprites, IGUIFont* font);
+
+	// Text is drawn from the upper left corner of the rect, like a static text
+	void setLayout(Label label, const rect<s32>& position, SColor color);
+	void setColor(Label label, SColor color);
+
+	void setAmmo(s32 ammo);
+	void setHealth(s32 health);
+	void setTimer(s32 seconds);
+	void setWave(s32 wave);
+	void setKills(s32 kills);
+	void setMoney(s32 money);
+	void setPowerupTimer(u32 slot, bool active, f32 seconds);
+
+	void setVisible(bool visible) { m_visible = visible; }
+
+	void draw();
+
+	// Labels reformatted by the last draw()
+	u32 getFormatCount() const { return m_formatCount; }
+
+private:
+	struct Glyph
+	{
+		s32 page;
+		rect<s32> dest;
+		rect<f32> uv;
+	};
+
+	struct Field
+	{
+		s32 value;
+		bool shown;
+		bool dirty;
+		rect<s32> position;
+		SColor color;
+		wchar_t text[32];
+		array<Glyph> glyphs;
+	};
+
+	void setValue(Label label, s32 value);
+	void format(Label label);
+	void layout(Field& field);
+
+	SpriteBatch*     m_sprites;
+	IGUIFont*        m_font;
+	IGUIFontBitmap*  m_bitmapFont; // null if the font can't be laid out here
+	array<s32>       m_fontPages;  // sprite batch page per font texture
+	Field            m_fields[LABEL_COUNT];
+	bool             m_visible;
+	u32              m_formatCount;
+};
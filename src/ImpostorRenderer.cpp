@@ -0,0 +1,200 @@
+#include "ImpostorRenderer.h"
+#include <cmath>
+
+static const u32 ATLAS_SIZE = 1024;
+static const u32 CELL_SIZE = 64;
+static const u32 CELLS_PER_ROW = ATLAS_SIZE / CELL_SIZE;
+static const u32 IMPOSTOR_YAWS = 8;
+static const u32 IMPOSTOR_FRAMES = 8;
+static const u32 CELLS_PER_SKIN = IMPOSTOR_YAWS * IMPOSTOR_FRAMES;
+static const u32 MAX_IMPOSTORS = 65536 / 4; // 16-bit indices
+
+ImpostorRenderer::ImpostorRenderer(ISceneNode* parent, ISceneManager* smgr, s32 id)
+	: ISceneNode(parent, smgr, id)
+	, m_atlas(nullptr)
+{
+	// Instances are spread over the whole arena; skip the node-level box test
+	setAutomaticCulling(EAC_OFF);
+
+	IVideoDriver* driver = smgr->getVideoDriver();
+	if (driver->queryFeature(EVDF_RENDER_TO_TARGET))
+	{
+		m_atlas = driver->addRenderTargetTexture(dimension2d<u32>(ATLAS_SIZE, ATLAS_SIZE), "impostor_atlas", ECF_A8R8G8B8);
+		if (m_atlas)
+			m_atlas->grab();
+	}
+
+	m_material.setTexture(0, m_atlas);
+	m_material.MaterialType = EMT_TRANSPARENT_ALPHA_CHANNEL_REF;
+	m_material.Lighting = false;
+	m_material.BackfaceCulling = false;
+	m_material.FogEnable = true;
+}
+
+ImpostorRenderer::~ImpostorRenderer()
+{
+	clear();
+	if (m_atlas)
+		m_atlas->drop();
+}
+
+s32 ImpostorRenderer::addSkin(IAnimatedMesh* mesh, ITexture* texture)
+{
+	if (!m_atlas || !mesh || mesh->getMeshType() != EAMT_MD2)
+		return -1;
+
+	const u32 firstCell = m_skins.size() * CELLS_PER_SKIN;
+	if (firstCell + CELLS_PER_SKIN > CELLS_PER_ROW * CELLS_PER_ROW)
+		return -1;
+
+	s32 begin, end, fps;
+	static_cast<IAnimatedMeshMD2*>(mesh)->getFrameLoop(EMAT_RUN, begin, end, fps);
+
+	// Square that holds every sampled frame at every yaw
+	aabbox3df box = mesh->getMesh(begin)->getBoundingBox();
+	for (u32 f = 1; f < IMPOSTOR_FRAMES; f++)
+		box.addInternalBox(mesh->getMesh(begin + (end - begin) * f / IMPOSTOR_FRAMES)->getBoundingBox());
+	f32 radius = core::max_(core::max_(fabsf(box.MinEdge.X), fabsf(box.MaxEdge.X)),
+		core::max_(fabsf(box.MinEdge.Z), fabsf(box.MaxEdge.Z)));
+
+	Skin skin;
+	skin.firstCell = firstCell;
+	skin.halfSize = core::max_(radius, box.getExtent().Y * 0.5f) * 1.05f;
+	skin.centerY = box.getCenter().Y;
+
+	// Private scene with just the model and an orthographic camera
+	IVideoDriver* driver = SceneManager->getVideoDriver();
+	ISceneManager* scene = SceneManager->createNewSceneManager(false);
+	IAnimatedMeshSceneNode* node = scene->addAnimatedMeshSceneNode(mesh);
+	node->setMaterialTexture(0, texture);
+	node->setMaterialFlag(EMF_LIGHTING, false);
+	node->setFrameLoop(begin, end);
+	node->setAnimationSpeed(0.0f);
+
+	ICameraSceneNode* camera = scene->addCameraSceneNode(0,
+		vector3df(0, skin.centerY, -4.0f * skin.halfSize), vector3df(0, skin.centerY, 0));
+	matrix4 ortho;
+	ortho.buildProjectionMatrixOrthoLH(2.0f * skin.halfSize, 2.0f * skin.halfSize, skin.halfSize, 8.0f * skin.halfSize);
+	camera->setProjectionMatrix(ortho, true);
+
+	// Cells never overlap, so the color buffer is only cleared for the first skin
+	const rect<s32> oldViewPort = driver->getViewPort();
+	driver->setRenderTarget(m_atlas, m_skins.empty(), true, SColor(0, 0, 0, 0));
+	for (u32 yaw = 0; yaw < IMPOSTOR_YAWS; yaw++)
+	{
+		node->setRotation(vector3df(0, yaw * 360.0f / IMPOSTOR_YAWS, 0));
+		for (u32 f = 0; f < IMPOSTOR_FRAMES; f++)
+		{
+			node->setCurrentFrame(begin + (end - begin) * (f32)f / IMPOSTOR_FRAMES);
+
+			const u32 cell = firstCell + yaw * IMPOSTOR_FRAMES + f;
+			const s32 x = (cell % CELLS_PER_ROW) * CELL_SIZE;
+			const s32 y = (cell / CELLS_PER_ROW) * CELL_SIZE;
+			driver->setViewPort(rect<s32>(x, y, x + CELL_SIZE, y + CELL_SIZE));
+			scene->drawAll();
+		}
+	}
+	driver->setRenderTarget(0, false, false);
+	driver->setViewPort(oldViewPort);
+	scene->drop();
+
+	m_skins.push_back(skin);
+	return m_skins.size() - 1;
+}
+
+void ImpostorRenderer::clear()
+{
+	for (u32 i = 0; i < m_instances.size(); i++)
+		m_instances[i].node->drop();
+	m_instances.set_used(0);
+}
+
+void ImpostorRenderer::add(IAnimatedMeshSceneNode* node, s32 skin)
+{
+	if (!node || skin < 0 || skin >= (s32)m_skins.size() || m_instances.size() >= MAX_IMPOSTORS)
+		return;
+
+	node->grab();
+	Instance instance = { node, skin };
+	m_instances.push_back(instance);
+}
+
+void ImpostorRenderer::OnRegisterSceneNode()
+{
+	if (IsVisible && !m_instances.empty())
+		SceneManager->registerNodeForRendering(this, ESNRP_SOLID);
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+void ImpostorRenderer::render()
+{
+	ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+		return;
+
+	const vector3df cameraPos = camera->getAbsolutePosition();
+	const f32 cellUV = (f32)CELL_SIZE / ATLAS_SIZE;
+	const SColor white(255, 255, 255, 255);
+
+	m_vertices.set_used(0);
+	for (u32 i = 0; i < m_instances.size(); i++)
+	{
+		IAnimatedMeshSceneNode* node = m_instances[i].node;
+		const Skin& skin = m_skins[m_instances[i].skin];
+		if (!node->getParent())
+			continue; // removed from the scene since it was added
+
+		const vector3df pos = node->getAbsolutePosition();
+		vector3df toActor = pos - cameraPos;
+		toActor.Y = 0.0f;
+		if (toActor.getLengthSQ() < 1.0f)
+			continue;
+		toActor.normalize();
+
+		// Yaw of the actor as seen from the camera picks the atlas row
+		const f32 viewYaw = atan2f(toActor.X, toActor.Z) * RADTODEG;
+		s32 yaw = (s32)floorf((node->getRotation().Y - viewYaw) / (360.0f / IMPOSTOR_YAWS) + 0.5f);
+		yaw = ((yaw % (s32)IMPOSTOR_YAWS) + IMPOSTOR_YAWS) % IMPOSTOR_YAWS;
+
+		// Position in the node's current loop picks the frame
+		const s32 start = node->getStartFrame(), end = node->getEndFrame();
+		f32 loopPos = (end > start) ? (node->getFrameNr() - start) / (f32)(end - start + 1) : 0.0f;
+		s32 frame = core::clamp<s32>((s32)(loopPos * IMPOSTOR_FRAMES), 0, IMPOSTOR_FRAMES - 1);
+
+		const u32 cell = skin.firstCell + yaw * IMPOSTOR_FRAMES + frame;
+		const f32 u0 = (cell % CELLS_PER_ROW) * cellUV, v0 = (cell / CELLS_PER_ROW) * cellUV;
+		const f32 u1 = u0 + cellUV, v1 = v0 + cellUV;
+
+		const f32 scale = node->getScale().Y;
+		const vector3df center = pos + vector3df(0, skin.centerY * scale, 0);
+		const vector3df right = vector3df(toActor.Z, 0, -toActor.X) * (skin.halfSize * scale);
+		const vector3df up(0, skin.halfSize * scale, 0);
+		const vector3df normal = -toActor;
+
+		m_vertices.push_back(S3DVertex(center - right - up, normal, white, vector2df(u0, v1)));
+		m_vertices.push_back(S3DVertex(center - right + up, normal, white, vector2df(u0, v0)));
+		m_vertices.push_back(S3DVertex(center + right + up, normal, white, vector2df(u1, v0)));
+		m_vertices.push_back(S3DVertex(center + right - up, normal, white, vector2df(u1, v1)));
+	}
+
+	const u32 quads = m_vertices.size() / 4;
+	if (quads == 0)
+		return;
+
+	for (u32 q = m_indices.size() / 6; q < quads; q++)
+	{
+		const u16 base = (u16)(q * 4);
+		m_indices.push_back(base);
+		m_indices.push_back(base + 1);
+		m_indices.push_back(base + 2);
+		m_indices.push_back(base);
+		m_indices.push_back(base + 2);
+		m_indices.push_back(base + 3);
+	}
+
+	IVideoDriver* driver = SceneManager->getVideoDriver();
+	driver->setTransform(ETS_WORLD, IdentityMatrix);
+	driver->setMaterial(m_material);
+	driver->drawIndexedTriangleList(m_vertices.pointer(), m_vertices.size(), m_indices.pointer(), quads * 2);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Camera-facing billboards for distant MD2 actors. At startup each skin is
+// rendered into one shared atlas texture (8 yaw directions x 8 frames of its
+// run loop); every frame the actors handed in through add() are drawn as
+// alpha-tested quads sampling the closest yaw and frame, all in one call.
+// The caller decides which actors are impostors and hides their nodes.
+class ImpostorRenderer : public ISceneNode
+{
+public:
+	ImpostorRenderer(ISceneNode* parent, ISceneManager* smgr, s32 id = -1);
+	~ImpostorRenderer();
+
+	// Renders the skin into the next atlas slot; returns the skin index or -1
+	// (no render target support, atlas full). Must be called between the
+	// driver's beginScene() and endScene().
+	s32 addSkin(IAnimatedMesh* mesh, ITexture* texture);
+	bool isAvailable() const { return m_atlas != nullptr; }
+
+	// Per-frame instance list
+	void clear();
+	void add(IAnimatedMeshSceneNode* node, s32 skin);
+	u32 getInstanceCount() const { return m_instances.size(); }
+
+	void OnRegisterSceneNode() override;
+	void render() override;
+	const aabbox3df& getBoundingBox() const override { return m_box; }
+	u32 getMaterialCount() const override { return 1; }
+	SMaterial& getMaterial(u32 i) override { return m_material; }
+
+private:
+	struct Skin
+	{
+		u32 firstCell;
+		f32 halfSize;  // half extent of the square each cell shows, in model units
+		f32 centerY;   // model-space height of the cell center
+	};
+
+	struct Instance
+	{
+		IAnimatedMeshSceneNode* node;
+		s32 skin;
+	};
+
+	ITexture*        m_atlas;
+	array<Skin>      m_skins;
+	array<Instance>  m_instances;
+	array<S3DVertex> m_vertices;
+	array<u16>       m_indices;
+	SMaterial        m_material;
+	aabbox3df        m_box;
+};
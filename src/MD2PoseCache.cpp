@@ -0,0 +1,118 @@
+#include "MD2PoseCache.h"
+#include <cstring>
+
+// Poses kept per mesh before the cache is flushed (~18 KB each for tris.md2)
+static const u32 MAX_CACHED_POSES = 1024;
+
+MD2PoseCache* MD2PoseCache::install(ISceneManager* smgr, const io::path& path)
+{
+	IAnimatedMesh* mesh = smgr->getMesh(path);
+	if (!mesh || mesh->getMeshType() != EAMT_MD2)
+		return nullptr;
+
+	MD2PoseCache* cache = new MD2PoseCache(mesh);
+	smgr->getMeshCache()->removeMesh(mesh);
+	smgr->getMeshCache()->addMesh(path, cache);
+	cache->drop();
+	return cache;
+}
+
+MD2PoseCache::MD2PoseCache(IAnimatedMesh* mesh)
+	: m_mesh(static_cast<IAnimatedMeshMD2*>(mesh))
+	, m_current(mesh)
+	, m_hits(0)
+	, m_misses(0)
+{
+	m_mesh->grab();
+	m_current->grab();
+}
+
+MD2PoseCache::~MD2PoseCache()
+{
+	clear();
+	m_current->drop();
+	m_mesh->drop();
+}
+
+void MD2PoseCache::setCurrent(IMesh* pose)
+{
+	pose->grab();
+	m_current->drop();
+	m_current = pose;
+}
+
+void MD2PoseCache::clear()
+{
+	for (auto& entry : m_poses)
+		entry.second->drop();
+	m_poses.clear();
+}
+
+IMesh* MD2PoseCache::getMesh(s32 frame, s32 detailLevel, s32 startFrameLoop, s32 endFrameLoop)
+{
+	// Same normalization as CAnimatedMeshMD2::getMesh, so equal keys mean equal poses
+	const u32 frameCount = m_mesh->getFrameCount();
+	if ((u32)frame > frameCount)
+		frame = frame % frameCount;
+	if (startFrameLoop == -1 && endFrameLoop == -1)
+	{
+		startFrameLoop = 0;
+		endFrameLoop = frameCount;
+	}
+
+	const u64 key = ((u64)(u16)startFrameLoop << 32) | ((u64)(u16)endFrameLoop << 16) | (u16)frame;
+	auto it = m_poses.find(key);
+	if (it != m_poses.end())
+	{
+		m_hits++;
+		setCurrent(it->second);
+		return it->second;
+	}
+
+	m_misses++;
+	if (m_poses.size() >= MAX_CACHED_POSES)
+		clear();
+
+	IMesh* interpolated = m_mesh->getMesh(frame, detailLevel, startFrameLoop, endFrameLoop);
+	IMeshBuffer* src = interpolated->getMeshBuffer(0);
+
+	SMeshBuffer* buffer = new SMeshBuffer();
+	buffer->Material = src->getMaterial();
+	const S3DVertex* vertices = static_cast<const S3DVertex*>(src->getVertices());
+	buffer->Vertices.set_used(src->getVertexCount());
+	for (u32 i = 0; i < src->getVertexCount(); i++)
+		buffer->Vertices[i] = vertices[i];
+	buffer->Indices.set_used(src->getIndexCount());
+	memcpy(buffer->Indices.pointer(), src->getIndices(), src->getIndexCount() * sizeof(u16));
+	buffer->BoundingBox = src->getBoundingBox();
+	buffer->setHardwareMappingHint(EHM_STATIC);
+
+	SMesh* pose = new SMesh();
+	pose->addMeshBuffer(buffer);
+	pose->BoundingBox = buffer->BoundingBox;
+	buffer->drop();
+
+	m_poses[key] = pose;
+	setCurrent(pose);
+	return pose;
+}
+
+void MD2PoseCache::getFrameLoop(EMD2_ANIMATION_TYPE l, s32& outBegin, s32& outEnd, s32& outFPS) const
+{
+	m_mesh->getFrameLoop(l, outBegin, outEnd, outFPS);
+}
+
+bool MD2PoseCache::getFrameLoop(const c8* name, s32& outBegin, s32& outEnd, s32& outFPS) const
+{
+	return m_mesh->getFrameLoop(name, outBegin, outEnd, outFPS);
+}
+
+s32 MD2PoseCache::getAnimationCount() const
+{
+	return m_mesh->getAnimationCount();
+}
+
+const c8* MD2PoseCache::getAnimationName(s32 nr) const
+{
+	return m_mesh->getAnimationName(nr);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <irrlicht.h>
+#include <unordered_map>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Wraps an MD2 mesh so every node using it shares interpolated poses.
+// CAnimatedMeshMD2 has one interpolation buffer and re-lerps every vertex on
+// each getMesh() call (twice per node per frame: OnAnimate and render). Here
+// each (loop start, loop end, frame) is interpolated once, copied into its own
+// static mesh buffer and reused by every node showing that pose, so skinning
+// cost follows the number of distinct poses instead of the number of enemies.
+// MD2 frames are already quantized to 1/4 of a key frame, which is the key.
+class MD2PoseCache : public IAnimatedMeshMD2
+{
+public:
+	// Replaces the mesh cached under path in the scene manager with a pose
+	// cache, so later smgr->getMesh(path) calls return it. Returns nullptr if
+	// the file isn't an MD2 mesh.
+	static MD2PoseCache* install(ISceneManager* smgr, const io::path& path);
+
+	MD2PoseCache(IAnimatedMesh* mesh);
+	~MD2PoseCache();
+
+	IMesh* getMesh(s32 frame, s32 detailLevel = 255, s32 startFrameLoop = -1, s32 endFrameLoop = -1) override;
+	u32 getFrameCount() const override { return m_mesh->getFrameCount(); }
+	f32 getAnimationSpeed() const override { return m_mesh->getAnimationSpeed(); }
+	void setAnimationSpeed(f32 fps) override { m_mesh->setAnimationSpeed(fps); }
+	E_ANIMATED_MESH_TYPE getMeshType() const override { return EAMT_MD2; }
+
+	void getFrameLoop(EMD2_ANIMATION_TYPE l, s32& outBegin, s32& outEnd, s32& outFPS) const override;
+	bool getFrameLoop(const c8* name, s32& outBegin, s32& outEnd, s32& outFPS) const override;
+	s32 getAnimationCount() const override;
+	const c8* getAnimationName(s32 nr) const override;
+
+	// As with CAnimatedMeshMD2, the IMesh side shows the last returned pose
+	u32 getMeshBufferCount() const override { return m_current->getMeshBufferCount(); }
+	IMeshBuffer* getMeshBuffer(u32 nr) const override { return m_current->getMeshBuffer(nr); }
+	IMeshBuffer* getMeshBuffer(const SMaterial& material) const override { return m_current->getMeshBuffer(material); }
+	const aabbox3df& getBoundingBox() const override { return m_current->getBoundingBox(); }
+	void setBoundingBox(const aabbox3df& box) override { m_current->setBoundingBox(box); }
+	void setMaterialFlag(E_MATERIAL_FLAG flag, bool newvalue) override { m_mesh->setMaterialFlag(flag, newvalue); }
+	void setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint, E_BUFFER_TYPE buffer = EBT_VERTEX_AND_INDEX) override {}
+	void setDirty(E_BUFFER_TYPE buffer = EBT_VERTEX_AND_INDEX) override {}
+
+	u32 getHits() const { return m_hits; }
+	u32 getMisses() const { return m_misses; }
+	u32 getPoseCount() const { return (u32)m_poses.size(); }
+	void resetStats() { m_hits = 0; m_misses = 0; }
+
+private:
+	void setCurrent(IMesh* pose);
+	void clear();
+
+	IAnimatedMeshMD2* m_mesh;
+	IMesh* m_current;
+	std::unordered_map<u64, SMesh*> m_poses;
+	u32 m_hits;
+	u32 m_misses;
+};
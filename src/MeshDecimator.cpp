@@ -0,0 +1,646 @@
+#include "MeshDecimator.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <vector>
+
+// Vertices closer than this are one point of the topology, in model units
+static const f32 POSITION_EPSILON = 0.0001f;
+
+// Open edges weigh this much more than faces, so outlines stay put
+static const f64 BOUNDARY_WEIGHT = 100.0;
+
+// A collapse may turn a triangle's normal by at most acos of this
+static const f64 FLIP_MIN_COS = 0.2;
+
+// Closest point of a triangle to p, interior included (Ericson, Real-Time
+// Collision Detection 5.1.5); triangle3d::closestPointOnTriangle only
+// looks at the edges
+static vector3df closestPoint(const triangle3df& triangle, const vector3df& p)
+{
+	const vector3df& a = triangle.pointA;
+	const vector3df& b = triangle.pointB;
+	const vector3df& c = triangle.pointC;
+	const vector3df ab = b - a, ac = c - a, ap = p - a;
+	const f32 d1 = ab.dotProduct(ap), d2 = ac.dotProduct(ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+		return a;
+
+	const vector3df bp = p - b;
+	const f32 d3 = ab.dotProduct(bp), d4 = ac.dotProduct(bp);
+	if (d3 >= 0.0f && d4 <= d3)
+		return b;
+
+	const f32 vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		return a + ab * (d1 / (d1 - d3));
+
+	const vector3df cp = p - c;
+	const f32 d5 = ab.dotProduct(cp), d6 = ac.dotProduct(cp);
+	if (d6 >= 0.0f && d5 <= d6)
+		return c;
+
+	const f32 vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		return a + ac * (d2 / (d2 - d6));
+
+	const f32 va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+	const f32 denom = 1.0f / (va + vb + vc);
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Distance from p to the nearest of the triangles, stopping early once it
+// is known to be within limit
+static f32 distanceToTriangles(const vector3df& p, const triangle3df* triangles, u32 count, f32 limit)
+{
+	const f32 limitSQ = limit * limit;
+	f32 nearest = FLT_MAX;
+	for (u32 t = 0; t < count && nearest > limitSQ; t++)
+	{
+		const f32 distance = p.getDistanceFromSQ(closestPoint(triangles[t], p));
+		if (distance < nearest)
+			nearest = distance;
+	}
+	return sqrtf(nearest);
+}
+
+namespace
+{
+	// Sum of squared distances to a set of planes, as a symmetric 4x4 matrix
+	struct Quadric
+	{
+		f64 a[10];
+
+		void clear()
+		{
+			for (u32 i = 0; i < 10; i++)
+				a[i] = 0.0;
+		}
+
+		void addPlane(f64 nx, f64 ny, f64 nz, f64 d, f64 weight)
+		{
+			a[0] += weight * nx * nx; a[1] += weight * nx * ny; a[2] += weight * nx * nz; a[3] += weight * nx * d;
+			a[4] += weight * ny * ny; a[5] += weight * ny * nz; a[6] += weight * ny * d;
+			a[7] += weight * nz * nz; a[8] += weight * nz * d;
+			a[9] += weight * d * d;
+		}
+
+		void add(const Quadric& other)
+		{
+			for (u32 i = 0; i < 10; i++)
+				a[i] += other.a[i];
+		}
+
+		f64 evaluate(const vector3df& p) const
+		{
+			const f64 x = p.X, y = p.Y, z = p.Z;
+			return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+				+ a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+				+ a[7] * z * z + 2.0 * a[8] * z + a[9];
+		}
+	};
+
+	struct PositionKey
+	{
+		s32 q[3];
+		u32 vertex;
+
+		bool operator<(const PositionKey& other) const
+		{
+			for (u32 i = 0; i < 3; i++)
+				if (q[i] != other.q[i])
+					return q[i] < other.q[i];
+			return vertex < other.vertex;
+		}
+	};
+
+	// Moves position from onto position to. Versions go stale when either
+	// end changes, so queued entries are checked instead of removed.
+	struct Collapse
+	{
+		f64 cost;
+		u32 from, to;
+		u32 fromVersion, toVersion;
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+	struct Decimator
+	{
+		array<vector3df> positions;
+		array<Quadric> quadrics;
+		array<bool> locked, alive;
+		array<u32> version;
+		std::vector<std::vector<u32> > positionTris;
+		const S3DVertex* vertices;
+		array<u32> triPositions;   // three position ids per triangle
+		array<u32> triCorners;     // and the buffer vertices at those corners
+		array<bool> removed;
+		u32 liveTriangles;
+		array<triangle3df> original;                  // the input surface
+		std::vector<std::vector<vector3df> > samples; // input points each position answers for
+		f32 maxError;
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse> > queue;
+
+		bool hasPosition(u32 t, u32 p) const
+		{
+			return triPositions[t * 3] == p || triPositions[t * 3 + 1] == p || triPositions[t * 3 + 2] == p;
+		}
+
+		vector3df normal(u32 t, u32 from, u32 to) const
+		{
+			vector3df v[3];
+			for (u32 k = 0; k < 3; k++)
+			{
+				const u32 p = triPositions[t * 3 + k];
+				v[k] = positions[p == from ? to : p];
+			}
+			return (v[1] - v[0]).crossProduct(v[2] - v[0]);
+		}
+
+		void push(u32 from, u32 to)
+		{
+			if (locked[from])
+				return;
+			Quadric q = quadrics[from];
+			q.add(quadrics[to]);
+			Collapse c = { q.evaluate(positions[to]), from, to, version[from], version[to] };
+			if (c.cost < 0.0)
+				c.cost = 0.0;
+			queue.push(c);
+		}
+
+		void neighbours(u32 p, std::vector<u32>& out) const
+		{
+			out.clear();
+			for (u32 t : positionTris[p])
+			{
+				if (removed[t])
+					continue;
+				for (u32 k = 0; k < 3; k++)
+				{
+					const u32 n = triPositions[t * 3 + k];
+					if (n != p && std::find(out.begin(), out.end(), n) == out.end())
+						out.push_back(n);
+				}
+			}
+		}
+
+		// Pairs each corner at from with the corner at to that takes its place:
+		// the one across the collapsing edge, or failing that (a seam meets
+		// from away from the edge) any corner at to with the same attributes.
+		// Returns false when some corner has no match, as moving it would
+		// drag its texture along.
+		bool mapCorners(const Collapse& c, std::vector<u32>& corners) const
+		{
+			corners.clear();
+			for (u32 t : positionTris[c.from])
+			{
+				if (removed[t] || !hasPosition(t, c.to))
+					continue;
+				u32 fromCorner = 0, toCorner = 0;
+				for (u32 k = 0; k < 3; k++)
+				{
+					if (triPositions[t * 3 + k] == c.from)
+						fromCorner = triCorners[t * 3 + k];
+					else if (triPositions[t * 3 + k] == c.to)
+						toCorner = triCorners[t * 3 + k];
+				}
+				corners.push_back(fromCorner);
+				corners.push_back(toCorner);
+			}
+
+			for (u32 t : positionTris[c.from])
+			{
+				if (removed[t] || hasPosition(t, c.to))
+					continue;
+				u32 fromCorner = 0;
+				for (u32 k = 0; k < 3; k++)
+					if (triPositions[t * 3 + k] == c.from)
+						fromCorner = triCorners[t * 3 + k];
+				if (findCorner(corners, fromCorner) >= 0)
+					continue;
+
+				s32 match = -1;
+				for (u32 n : positionTris[c.to])
+				{
+					if (removed[n])
+						continue;
+					for (u32 k = 0; k < 3 && match < 0; k++)
+					{
+						const u32 corner = triCorners[n * 3 + k];
+						if (triPositions[n * 3 + k] == c.to && sameAttributes(vertices[corner], vertices[fromCorner]))
+							match = (s32)corner;
+					}
+					if (match >= 0)
+						break;
+				}
+				if (match < 0)
+					return false;
+				corners.push_back(fromCorner);
+				corners.push_back((u32)match);
+			}
+			return true;
+		}
+
+		static s32 findCorner(const std::vector<u32>& corners, u32 fromCorner)
+		{
+			for (u32 i = 0; i < corners.size(); i += 2)
+				if (corners[i] == fromCorner)
+					return (s32)corners[i + 1];
+			return -1;
+		}
+
+		static bool sameAttributes(const S3DVertex& a, const S3DVertex& b)
+		{
+			return a.TCoords.equals(b.TCoords) && a.Normal.equals(b.Normal) && a.Color == b.Color;
+		}
+
+		bool isLegal(const Collapse& c, std::vector<u32>& fromRing, std::vector<u32>& toRing,
+			std::vector<u32>& corners) const
+		{
+			// Link condition: the ends may only share the vertices opposite
+			// the edge, or the collapse pinches the surface
+			u32 shared = 0;
+			for (u32 t : positionTris[c.from])
+				if (!removed[t] && hasPosition(t, c.to))
+					shared++;
+			if (shared == 0)
+				return false;
+
+			neighbours(c.from, fromRing);
+			neighbours(c.to, toRing);
+			u32 common = 0;
+			for (u32 n : fromRing)
+				if (std::find(toRing.begin(), toRing.end(), n) != toRing.end())
+					common++;
+			if (common > shared)
+				return false;
+
+			// No triangle that stays may fold over or collapse to a sliver
+			for (u32 t : positionTris[c.from])
+			{
+				if (removed[t] || hasPosition(t, c.to))
+					continue;
+				const vector3df before = normal(t, c.from, c.from);
+				const vector3df after = normal(t, c.from, c.to);
+				const f64 lengths = sqrt((f64)before.getLengthSQ() * after.getLengthSQ());
+				if (lengths <= 0.0 || before.dotProduct(after) < FLIP_MIN_COS * lengths)
+					return false;
+			}
+			return mapCorners(c, corners) && withinError(c, fromRing, toRing);
+		}
+
+		// Quadrics only see planes, so a collapse along a crease can spread
+		// a face over an opening at no cost. Every input vertex and triangle
+		// centre is a sample owned by a point; the collapse is kept only if
+		// the samples of the points around it stay near the new surface and
+		// the new triangles stay near the input surface.
+		bool withinError(const Collapse& c, std::vector<u32>& points, std::vector<u32>& triangles) const
+		{
+			points.clear();
+			triangles.clear();
+			for (u32 side = 0; side < 2; side++)
+			{
+				for (u32 t : positionTris[side == 0 ? c.from : c.to])
+				{
+					if (removed[t])
+						continue;
+					for (u32 k = 0; k < 3; k++)
+					{
+						const u32 p = triPositions[t * 3 + k];
+						if (p != c.from && std::find(points.begin(), points.end(), p) == points.end())
+							points.push_back(p);
+					}
+				}
+			}
+
+			for (u32 p : points)
+			{
+				for (u32 t : positionTris[p])
+				{
+					if (!removed[t] && !(hasPosition(t, c.from) && hasPosition(t, c.to))
+						&& std::find(triangles.begin(), triangles.end(), t) == triangles.end())
+						triangles.push_back(t);
+				}
+			}
+
+			std::vector<triangle3df> surface;
+			surface.reserve(triangles.size());
+			for (u32 t : triangles)
+			{
+				vector3df v[3];
+				for (u32 k = 0; k < 3; k++)
+				{
+					const u32 p = triPositions[t * 3 + k];
+					v[k] = positions[p == c.from ? c.to : p];
+				}
+				surface.push_back(triangle3df(v[0], v[1], v[2]));
+			}
+			if (surface.empty())
+				return false;
+
+			for (u32 i = 0; i < triangles.size(); i++)
+			{
+				if (!hasPosition(triangles[i], c.from))
+					continue;
+				const triangle3df& triangle = surface[i];
+				const vector3df centre = (triangle.pointA + triangle.pointB + triangle.pointC) / 3.0f;
+				if (distanceToTriangles(centre, original.const_pointer(), original.size(), maxError) > maxError)
+					return false;
+			}
+
+			for (u32 side = 0; side < 2; side++)
+			{
+				const std::vector<vector3df>& owned = samples[side == 0 ? c.from : c.to];
+				for (const vector3df& sample : owned)
+					if (distanceToTriangles(sample, &surface[0], surface.size(), maxError) > maxError)
+						return false;
+			}
+			for (u32 p : points)
+			{
+				if (p == c.to)
+					continue;
+				for (const vector3df& sample : samples[p])
+					if (distanceToTriangles(sample, &surface[0], surface.size(), maxError) > maxError)
+						return false;
+			}
+			return true;
+		}
+
+		void apply(const Collapse& c, const std::vector<u32>& corners)
+		{
+			for (u32 t : positionTris[c.from])
+			{
+				if (removed[t])
+					continue;
+				if (hasPosition(t, c.to))
+				{
+					removed[t] = true;
+					liveTriangles--;
+					continue;
+				}
+				for (u32 k = 0; k < 3; k++)
+				{
+					if (triPositions[t * 3 + k] == c.from)
+					{
+						triPositions[t * 3 + k] = c.to;
+						triCorners[t * 3 + k] = (u32)findCorner(corners, triCorners[t * 3 + k]);
+					}
+				}
+				positionTris[c.to].push_back(t);
+			}
+			positionTris[c.from].clear();
+
+			quadrics[c.to].add(quadrics[c.from]);
+			samples[c.to].insert(samples[c.to].end(), samples[c.from].begin(), samples[c.from].end());
+			samples[c.from].clear();
+			alive[c.from] = false;
+			version[c.to]++;
+		}
+	};
+}
+
+static void planeOf(const vector3df& a, const vector3df& b, const vector3df& c, f64 n[3], f64& d, f64& area2)
+{
+	const f64 ux = b.X - a.X, uy = b.Y - a.Y, uz = b.Z - a.Z;
+	const f64 vx = c.X - a.X, vy = c.Y - a.Y, vz = c.Z - a.Z;
+	n[0] = uy * vz - uz * vy;
+	n[1] = uz * vx - ux * vz;
+	n[2] = ux * vy - uy * vx;
+	area2 = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if (area2 > 0.0)
+	{
+		n[0] /= area2; n[1] /= area2; n[2] /= area2;
+	}
+	d = -(n[0] * a.X + n[1] * a.Y + n[2] * a.Z);
+}
+
+// Largest distance from the sample points to the nearest of the triangles
+static f32 farthestSample(const array<vector3df>& samples, const array<triangle3df>& triangles)
+{
+	f32 farthest = 0.0f;
+	for (u32 s = 0; s < samples.size(); s++)
+	{
+		const f32 distance = distanceToTriangles(samples[s], triangles.const_pointer(), triangles.size(), farthest);
+		if (distance > farthest && distance < FLT_MAX)
+			farthest = distance;
+	}
+	return farthest;
+}
+
+SMeshBuffer* MeshDecimator::decimate(const SMeshBuffer* buffer, u32 targetTriangles, f32 maxError,
+	const array<bool>* locked, f32* error)
+{
+	const u32 vertexCount = buffer->Vertices.size();
+	const u32 triangleCount = buffer->Indices.size() / 3;
+	Decimator dec;
+	dec.maxError = maxError;
+
+	// Merge vertices by position
+	array<PositionKey> keys;
+	keys.set_used(vertexCount);
+	for (u32 v = 0; v < vertexCount; v++)
+	{
+		const vector3df& pos = buffer->Vertices[v].Pos;
+		PositionKey& key = keys[v];
+		key.q[0] = (s32)floorf(pos.X / POSITION_EPSILON + 0.5f);
+		key.q[1] = (s32)floorf(pos.Y / POSITION_EPSILON + 0.5f);
+		key.q[2] = (s32)floorf(pos.Z / POSITION_EPSILON + 0.5f);
+		key.vertex = v;
+	}
+	keys.sort();
+
+	array<u32> vertexPosition;
+	vertexPosition.set_used(vertexCount);
+	for (u32 i = 0; i < vertexCount; i++)
+	{
+		const PositionKey& key = keys[i];
+		if (i == 0 || key.q[0] != keys[i - 1].q[0] || key.q[1] != keys[i - 1].q[1] || key.q[2] != keys[i - 1].q[2])
+		{
+			dec.positions.push_back(buffer->Vertices[key.vertex].Pos);
+			dec.locked.push_back(false);
+		}
+		const u32 p = dec.positions.size() - 1;
+		vertexPosition[key.vertex] = p;
+		if (locked && (*locked)[key.vertex])
+			dec.locked[p] = true;
+	}
+
+	const u32 positionCount = dec.positions.size();
+	dec.quadrics.set_used(positionCount);
+	dec.alive.set_used(positionCount);
+	dec.version.set_used(positionCount);
+	dec.positionTris.resize(positionCount);
+	dec.samples.resize(positionCount);
+	for (u32 p = 0; p < positionCount; p++)
+	{
+		dec.quadrics[p].clear();
+		dec.alive[p] = true;
+		dec.version[p] = 0;
+		dec.samples[p].push_back(dec.positions[p]);
+	}
+
+	// Face planes; triangles already degenerate by position are dropped
+	dec.vertices = buffer->Vertices.const_pointer();
+	dec.triPositions.set_used(triangleCount * 3);
+	dec.triCorners.set_used(triangleCount * 3);
+	dec.removed.set_used(triangleCount);
+	dec.liveTriangles = 0;
+	array<u64> edges;
+	for (u32 t = 0; t < triangleCount; t++)
+	{
+		u32 p[3];
+		for (u32 k = 0; k < 3; k++)
+		{
+			dec.triCorners[t * 3 + k] = buffer->Indices[t * 3 + k];
+			p[k] = dec.triPositions[t * 3 + k] = vertexPosition[buffer->Indices[t * 3 + k]];
+		}
+
+		f64 n[3], d, area2;
+		planeOf(dec.positions[p[0]], dec.positions[p[1]], dec.positions[p[2]], n, d, area2);
+		dec.removed[t] = p[0] == p[1] || p[1] == p[2] || p[2] == p[0] || area2 <= 0.0;
+		if (dec.removed[t])
+			continue;
+
+		dec.liveTriangles++;
+		dec.original.push_back(triangle3df(dec.positions[p[0]], dec.positions[p[1]], dec.positions[p[2]]));
+		dec.samples[p[0]].push_back((dec.positions[p[0]] + dec.positions[p[1]] + dec.positions[p[2]]) / 3.0f);
+		for (u32 k = 0; k < 3; k++)
+		{
+			dec.quadrics[p[k]].addPlane(n[0], n[1], n[2], d, 1.0);
+			dec.positionTris[p[k]].push_back(t);
+
+			const u32 a = p[k], b = p[(k + 1) % 3];
+			edges.push_back(a < b ? ((u64)a << 32) | b : ((u64)b << 32) | a);
+		}
+	}
+	edges.sort();
+
+	// Edges used by one triangle are open: hold them with a plane through
+	// the edge, perpendicular to the face
+	for (u32 t = 0; t < triangleCount; t++)
+	{
+		if (dec.removed[t])
+			continue;
+		const u32* p = &dec.triPositions[t * 3];
+		f64 n[3], d, area2;
+		planeOf(dec.positions[p[0]], dec.positions[p[1]], dec.positions[p[2]], n, d, area2);
+		for (u32 k = 0; k < 3; k++)
+		{
+			const u32 a = p[k], b = p[(k + 1) % 3];
+			const u64 key = a < b ? ((u64)a << 32) | b : ((u64)b << 32) | a;
+			const s32 at = edges.binary_search(key);
+			const bool open = (at == 0 || edges[at - 1] != key) && ((u32)at + 1 >= edges.size() || edges[at + 1] != key);
+			if (!open)
+				continue;
+
+			const vector3df& pa = dec.positions[a];
+			const vector3df edge = dec.positions[b] - pa;
+			f64 bx = edge.Y * n[2] - edge.Z * n[1];
+			f64 by = edge.Z * n[0] - edge.X * n[2];
+			f64 bz = edge.X * n[1] - edge.Y * n[0];
+			const f64 length = sqrt(bx * bx + by * by + bz * bz);
+			if (length <= 0.0)
+				continue;
+			bx /= length; by /= length; bz /= length;
+			const f64 bd = -(bx * pa.X + by * pa.Y + bz * pa.Z);
+			dec.quadrics[a].addPlane(bx, by, bz, bd, BOUNDARY_WEIGHT);
+			dec.quadrics[b].addPlane(bx, by, bz, bd, BOUNDARY_WEIGHT);
+		}
+	}
+
+	for (u32 i = 0; i < edges.size(); i++)
+	{
+		if (i > 0 && edges[i] == edges[i - 1])
+			continue;
+		const u32 a = (u32)(edges[i] >> 32), b = (u32)(edges[i] & 0xffffffff);
+		dec.push(a, b);
+		dec.push(b, a);
+	}
+
+	// Cheapest legal collapse first until the target is met
+	u32 collapses = 0;
+	std::vector<u32> fromRing, toRing, ring, corners;
+	while (dec.liveTriangles > targetTriangles && !dec.queue.empty())
+	{
+		const Collapse c = dec.queue.top();
+		dec.queue.pop();
+		if (!dec.alive[c.from] || !dec.alive[c.to]
+			|| dec.version[c.from] != c.fromVersion || dec.version[c.to] != c.toVersion)
+			continue;
+		if (!dec.isLegal(c, fromRing, toRing, corners))
+			continue;
+
+		dec.apply(c, corners);
+		collapses++;
+
+		dec.neighbours(c.to, ring);
+		for (u32 n : ring)
+		{
+			dec.push(c.to, n);
+			dec.push(n, c.to);
+		}
+	}
+
+	// Surviving corners are input vertices, so nothing needs moving
+	SMeshBuffer* out = new SMeshBuffer();
+	out->Material = buffer->Material;
+	array<s32> remap;
+	remap.set_used(vertexCount);
+	for (u32 v = 0; v < vertexCount; v++)
+		remap[v] = -1;
+
+	for (u32 t = 0; t < triangleCount; t++)
+	{
+		if (dec.removed[t])
+			continue;
+		for (u32 k = 0; k < 3; k++)
+		{
+			const u32 index = dec.triCorners[t * 3 + k];
+			if (remap[index] < 0)
+			{
+				remap[index] = out->Vertices.size();
+				out->Vertices.push_back(buffer->Vertices[index]);
+			}
+			out->Indices.push_back((u16)remap[index]);
+		}
+	}
+	out->recalculateBoundingBox();
+
+	// The final error is measured the same way the collapses were checked:
+	// vertices and triangle centres of each surface against the other one
+	if (error)
+	{
+		*error = 0.0f;
+		if (collapses > 0)
+		{
+			array<vector3df> originalSamples, decimatedSamples;
+			array<triangle3df> decimatedTriangles;
+			for (u32 t = 0; t < dec.original.size(); t++)
+			{
+				const triangle3df& triangle = dec.original[t];
+				originalSamples.push_back((triangle.pointA + triangle.pointB + triangle.pointC) / 3.0f);
+			}
+			for (u32 p = 0; p < positionCount; p++)
+				originalSamples.push_back(dec.positions[p]);
+
+			for (u32 i = 0; i < out->Indices.size(); i += 3)
+			{
+				triangle3df triangle(out->Vertices[out->Indices[i]].Pos, out->Vertices[out->Indices[i + 1]].Pos,
+					out->Vertices[out->Indices[i + 2]].Pos);
+				decimatedTriangles.push_back(triangle);
+				decimatedSamples.push_back((triangle.pointA + triangle.pointB + triangle.pointC) / 3.0f);
+			}
+
+			*error = core::max_(farthestSample(originalSamples, decimatedTriangles),
+				farthestSample(decimatedSamples, dec.original));
+		}
+	}
+	return out;
+}
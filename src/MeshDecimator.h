@@ -0,0 +1,29 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Quadric error edge collapse (Garland and Heckbert) for building lower
+// detail copies of static geometry. Vertices are merged by position for the
+// topology. Collapses are half-edge: the corners at the removed point are
+// replaced by the matching corners at the surviving one, so the output only
+// holds input vertices and texture seams stay where they were. Open edges
+// get extra quadric planes to hold their outline, and collapses that would
+// flip a triangle, pinch the surface or split a seam are skipped, as are
+// collapses whose new triangles would leave the input surface by more than
+// a given distance.
+namespace MeshDecimator
+{
+	// Returns a decimated copy of buffer with at most targetTriangles
+	// triangles, or fewer collapses when no legal ones are left. No collapse
+	// moves the surface further than maxError. locked has one entry per
+	// buffer vertex (or is null); locked vertices never move.
+	// error receives how far, in buffer units, the surface moved: the
+	// largest distance from a vertex or triangle centre of either surface to
+	// the other one (0 when nothing was collapsed).
+	SMeshBuffer* decimate(const SMeshBuffer* buffer, u32 targetTriangles, f32 maxError,
+		const array<bool>* locked, f32* error);
+}
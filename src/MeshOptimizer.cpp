@@ -0,0 +1,436 @@
+#include "MeshOptimizer.h"
+#include <cmath>
+
+static const u32 MAX_BUFFER_VERTICES = 65535;
+static const u32 ACMR_CACHE_SIZE = 16;
+
+// Weld tolerances, in model units before the node scale
+static const f32 WELD_POSITION_EPSILON = 0.0001f;
+static const f32 WELD_NORMAL_EPSILON = 0.001f;
+static const f32 WELD_TCOORD_EPSILON = 0.0001f;
+
+// Forsyth's scoring, with the constants from his article
+static const u32 FORSYTH_CACHE_SIZE = 32;
+static const f32 FORSYTH_CACHE_DECAY_POWER = 1.5f;
+static const f32 FORSYTH_LAST_TRI_SCORE = 0.75f;
+static const f32 FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+static const f32 FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+namespace
+{
+	// Vertex attributes snapped to the weld tolerances; vertices with equal
+	// keys are merged
+	struct WeldKey
+	{
+		s32 q[8];
+		u32 color;
+		u32 vertex;
+
+		bool operator<(const WeldKey& other) const
+		{
+			for (u32 i = 0; i < 8; i++)
+				if (q[i] != other.q[i])
+					return q[i] < other.q[i];
+			if (color != other.color)
+				return color < other.color;
+			return vertex < other.vertex;
+		}
+
+		bool sameVertex(const WeldKey& other) const
+		{
+			for (u32 i = 0; i < 8; i++)
+				if (q[i] != other.q[i])
+					return false;
+			return color == other.color;
+		}
+	};
+}
+
+static s32 quantize(f32 value, f32 epsilon)
+{
+	return (s32)floorf(value / epsilon + 0.5f);
+}
+
+static void readIndices(const IMeshBuffer* buffer, array<u32>& indices)
+{
+	const u32 count = buffer->getIndexCount();
+	indices.set_used(count);
+	if (buffer->getIndexType() == EIT_32BIT)
+	{
+		const u32* src = reinterpret_cast<const u32*>(buffer->getIndices());
+		for (u32 i = 0; i < count; i++)
+			indices[i] = src[i];
+	}
+	else
+	{
+		const u16* src = buffer->getIndices();
+		for (u32 i = 0; i < count; i++)
+			indices[i] = src[i];
+	}
+}
+
+static f32 simulateFIFO(const array<u32>& indices)
+{
+	const u32 triangles = indices.size() / 3;
+	if (triangles == 0)
+		return 0.0f;
+
+	u32 cache[ACMR_CACHE_SIZE];
+	u32 cached = 0, head = 0, misses = 0;
+	for (u32 i = 0; i < triangles * 3; i++)
+	{
+		bool hit = false;
+		for (u32 c = 0; c < cached && !hit; c++)
+			hit = cache[c] == indices[i];
+		if (hit)
+			continue;
+
+		misses++;
+		cache[head] = indices[i];
+		head = (head + 1) % ACMR_CACHE_SIZE;
+		if (cached < ACMR_CACHE_SIZE)
+			cached++;
+	}
+	return (f32)misses / triangles;
+}
+
+// Merges vertices that are equal within the tolerances, rewrites the
+// indices and drops triangles that became degenerate
+static void weld(array<S3DVertex>& vertices, array<u32>& indices)
+{
+	array<WeldKey> keys;
+	keys.set_used(vertices.size());
+	for (u32 v = 0; v < vertices.size(); v++)
+	{
+		const S3DVertex& vertex = vertices[v];
+		WeldKey& key = keys[v];
+		key.q[0] = quantize(vertex.Pos.X, WELD_POSITION_EPSILON);
+		key.q[1] = quantize(vertex.Pos.Y, WELD_POSITION_EPSILON);
+		key.q[2] = quantize(vertex.Pos.Z, WELD_POSITION_EPSILON);
+		key.q[3] = quantize(vertex.Normal.X, WELD_NORMAL_EPSILON);
+		key.q[4] = quantize(vertex.Normal.Y, WELD_NORMAL_EPSILON);
+		key.q[5] = quantize(vertex.Normal.Z, WELD_NORMAL_EPSILON);
+		key.q[6] = quantize(vertex.TCoords.X, WELD_TCOORD_EPSILON);
+		key.q[7] = quantize(vertex.TCoords.Y, WELD_TCOORD_EPSILON);
+		key.color = vertex.Color.color;
+		key.vertex = v;
+	}
+	keys.sort();
+
+	// Each run of equal keys keeps its lowest vertex
+	array<u32> remap;
+	remap.set_used(vertices.size());
+	array<S3DVertex> welded;
+	welded.reallocate(vertices.size());
+	for (u32 k = 0; k < keys.size(); k++)
+	{
+		if (k == 0 || !keys[k].sameVertex(keys[k - 1]))
+			welded.push_back(vertices[keys[k].vertex]);
+		remap[keys[k].vertex] = welded.size() - 1;
+	}
+
+	for (u32 i = 0; i < indices.size(); i++)
+		indices[i] = remap[indices[i]];
+
+	// Triangles that collapsed onto a repeated vertex draw nothing
+	u32 kept = 0;
+	for (u32 t = 0; t + 2 < indices.size(); t += 3)
+	{
+		const u32 a = indices[t], b = indices[t + 1], c = indices[t + 2];
+		if (a == b || b == c || a == c)
+			continue;
+		indices[kept++] = a;
+		indices[kept++] = b;
+		indices[kept++] = c;
+	}
+	indices.set_used(kept);
+
+	vertices.swap(welded);
+}
+
+static f32 forsythVertexScore(s32 cachePosition, u32 remainingTriangles)
+{
+	if (remainingTriangles == 0)
+		return -1.0f;
+
+	f32 score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The last triangle's vertices get a fixed score so the next pick
+		// doesn't just reuse the same edge
+		if (cachePosition < 3)
+			score = FORSYTH_LAST_TRI_SCORE;
+		else
+			score = powf(1.0f - (cachePosition - 3) / (f32)(FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+	}
+
+	// Vertices with few triangles left are finished first
+	score += FORSYTH_VALENCE_BOOST_SCALE * powf((f32)remainingTriangles, -FORSYTH_VALENCE_BOOST_POWER);
+	return score;
+}
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation" (2006). Greedily
+// emits the best scoring triangle, rescoring only the vertices in the
+// simulated LRU cache and their triangles after each one.
+static void orderTriangles(array<u32>& indices, u32 vertexCount)
+{
+	const u32 triangleCount = indices.size() / 3;
+	if (triangleCount < 2)
+		return;
+
+	// Triangles of each vertex, packed; the first remaining[v] entries of a
+	// vertex's range are the triangles not emitted yet
+	array<u32> remaining;
+	remaining.set_used(vertexCount);
+	for (u32 v = 0; v < vertexCount; v++)
+		remaining[v] = 0;
+	for (u32 i = 0; i < indices.size(); i++)
+		remaining[indices[i]]++;
+
+	array<u32> offset;
+	offset.set_used(vertexCount);
+	u32 sum = 0;
+	for (u32 v = 0; v < vertexCount; v++)
+	{
+		offset[v] = sum;
+		sum += remaining[v];
+	}
+
+	array<u32> adjacency;
+	adjacency.set_used(indices.size());
+	array<u32> fill;
+	fill.set_used(vertexCount);
+	for (u32 v = 0; v < vertexCount; v++)
+		fill[v] = 0;
+	for (u32 i = 0; i < indices.size(); i++)
+	{
+		const u32 v = indices[i];
+		adjacency[offset[v] + fill[v]++] = i / 3;
+	}
+
+	array<s32> cachePosition;
+	array<f32> vertexScore;
+	cachePosition.set_used(vertexCount);
+	vertexScore.set_used(vertexCount);
+	for (u32 v = 0; v < vertexCount; v++)
+	{
+		cachePosition[v] = -1;
+		vertexScore[v] = forsythVertexScore(-1, remaining[v]);
+	}
+
+	array<bool> emitted;
+	emitted.set_used(triangleCount);
+	s32 best = 0;
+	f32 bestScore = -1.0f;
+	for (u32 t = 0; t < triangleCount; t++)
+	{
+		emitted[t] = false;
+		const f32 score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (score > bestScore)
+		{
+			bestScore = score;
+			best = t;
+		}
+	}
+
+	array<u32> ordered;
+	ordered.reallocate(indices.size());
+	array<u32> cache, nextCache;
+	cache.reallocate(FORSYTH_CACHE_SIZE + 3);
+	nextCache.reallocate(FORSYTH_CACHE_SIZE + 3);
+	u32 scan = 0;
+
+	for (u32 n = 0; n < triangleCount; n++)
+	{
+		// Nothing in the cache has triangles left: take the next unemitted
+		// one in file order rather than rescanning the whole mesh
+		if (best < 0)
+		{
+			while (emitted[scan])
+				scan++;
+			best = scan;
+		}
+
+		const u32* tri = &indices[best * 3];
+		emitted[best] = true;
+		ordered.push_back(tri[0]);
+		ordered.push_back(tri[1]);
+		ordered.push_back(tri[2]);
+
+		nextCache.set_used(0);
+		for (u32 k = 0; k < 3; k++)
+		{
+			const u32 v = tri[k];
+			nextCache.push_back(v);
+
+			// Swap the triangle out of the vertex's remaining range
+			u32* list = &adjacency[offset[v]];
+			for (u32 a = 0; a < remaining[v]; a++)
+			{
+				if (list[a] == (u32)best)
+				{
+					list[a] = list[remaining[v] - 1];
+					list[remaining[v] - 1] = best;
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+		for (u32 c = 0; c < cache.size(); c++)
+		{
+			const u32 v = cache[c];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				nextCache.push_back(v);
+		}
+
+		// Rescore everything that was or is in the cache, then the triangles
+		// touching it; the best of those is the next candidate
+		for (u32 c = 0; c < nextCache.size(); c++)
+		{
+			const u32 v = nextCache[c];
+			cachePosition[v] = c < FORSYTH_CACHE_SIZE ? (s32)c : -1;
+			vertexScore[v] = forsythVertexScore(cachePosition[v], remaining[v]);
+		}
+
+		best = -1;
+		bestScore = -1.0f;
+		for (u32 c = 0; c < nextCache.size(); c++)
+		{
+			const u32 v = nextCache[c];
+			const u32* list = &adjacency[offset[v]];
+			for (u32 a = 0; a < remaining[v]; a++)
+			{
+				const u32 t = list[a];
+				const f32 score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+				if (score > bestScore)
+				{
+					bestScore = score;
+					best = t;
+				}
+			}
+		}
+
+		if (nextCache.size() > FORSYTH_CACHE_SIZE)
+			nextCache.set_used(FORSYTH_CACHE_SIZE);
+		cache.swap(nextCache);
+	}
+
+	indices.swap(ordered);
+}
+
+// Cuts the ordered triangles into buffers of at most MAX_BUFFER_VERTICES,
+// numbering vertices in the order the triangles first use them
+static void emitBuffers(const array<S3DVertex>& vertices, const array<u32>& indices,
+	const SMaterial& material, SMesh* out)
+{
+	array<s32> remap;
+	remap.set_used(vertices.size());
+	for (u32 v = 0; v < remap.size(); v++)
+		remap[v] = -1;
+
+	SMeshBuffer* buffer = nullptr;
+	array<u32> used; // vertices mapped into the current buffer, to reset remap
+	for (u32 t = 0; t + 2 < indices.size(); t += 3)
+	{
+		u32 added = 0;
+		for (u32 k = 0; k < 3; k++)
+			if (!buffer || remap[indices[t + k]] < 0)
+				added++;
+
+		if (!buffer || buffer->Vertices.size() + added > MAX_BUFFER_VERTICES)
+		{
+			for (u32 u = 0; u < used.size(); u++)
+				remap[used[u]] = -1;
+			used.set_used(0);
+
+			buffer = new SMeshBuffer();
+			buffer->Material = material;
+			out->addMeshBuffer(buffer);
+			buffer->drop();
+		}
+
+		for (u32 k = 0; k < 3; k++)
+		{
+			const u32 v = indices[t + k];
+			if (remap[v] < 0)
+			{
+				remap[v] = buffer->Vertices.size();
+				buffer->Vertices.push_back(vertices[v]);
+				used.push_back(v);
+			}
+			buffer->Indices.push_back((u16)remap[v]);
+		}
+	}
+}
+
+SMesh* MeshOptimizer::optimize(IMesh* mesh, Stats* stats)
+{
+	Stats s = { 0, 0, 0, 0, 0, 0.0f, 0.0f };
+	SMesh* out = new SMesh();
+	if (!mesh)
+	{
+		if (stats)
+			*stats = s;
+		return out;
+	}
+
+	f32 missesBefore = 0.0f;
+	u32 trianglesBefore = 0;
+	array<S3DVertex> vertices;
+	array<u32> indices;
+	for (u32 b = 0; b < mesh->getMeshBufferCount(); b++)
+	{
+		IMeshBuffer* src = mesh->getMeshBuffer(b);
+		s.buffersBefore++;
+		s.verticesBefore += src->getVertexCount();
+
+		if (src->getVertexType() != EVT_STANDARD)
+		{
+			out->addMeshBuffer(src);
+			continue;
+		}
+
+		readIndices(src, indices);
+		missesBefore += simulateFIFO(indices) * (indices.size() / 3);
+		trianglesBefore += indices.size() / 3;
+
+		const S3DVertex* srcVertices = static_cast<const S3DVertex*>(src->getVertices());
+		vertices.set_used(0);
+		for (u32 v = 0; v < src->getVertexCount(); v++)
+			vertices.push_back(srcVertices[v]);
+
+		weld(vertices, indices);
+		orderTriangles(indices, vertices.size());
+		emitBuffers(vertices, indices, src->getMaterial(), out);
+		s.triangles += indices.size() / 3;
+	}
+
+	f32 missesAfter = 0.0f;
+	for (u32 b = 0; b < out->getMeshBufferCount(); b++)
+	{
+		IMeshBuffer* buffer = out->getMeshBuffer(b);
+		buffer->recalculateBoundingBox();
+		s.verticesAfter += buffer->getVertexCount();
+		if (buffer->getVertexType() == EVT_STANDARD)
+			missesAfter += getACMR(buffer) * (buffer->getIndexCount() / 3);
+	}
+	out->recalculateBoundingBox();
+	s.buffersAfter = out->getMeshBufferCount();
+
+	// Weighted by triangles, over the optimized buffers only
+	if (trianglesBefore > 0)
+		s.acmrBefore = missesBefore / trianglesBefore;
+	if (s.triangles > 0)
+		s.acmrAfter = missesAfter / s.triangles;
+
+	if (stats)
+		*stats = s;
+	return out;
+}
+
+f32 MeshOptimizer::getACMR(const IMeshBuffer* buffer)
+{
+	array<u32> indices;
+	readIndices(buffer, indices);
+	return simulateFIFO(indices);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Load time cleanup for static meshes that are drawn as loaded (the
+// Colosseum, and the gates through the static batch). The OBJ loader emits
+// buffers in file face order and only merges bit-identical vertices, so:
+//  - vertices that match within a small tolerance are welded,
+//  - triangles are reordered for the post-transform vertex cache with Tom
+//    Forsyth's linear-speed algorithm,
+//  - vertices are renumbered in first-use order so fetches walk forwards,
+//  - buffers are split wherever 16-bit indices would run out.
+// Only EVT_STANDARD buffers are optimized; others are passed through.
+namespace MeshOptimizer
+{
+	struct Stats
+	{
+		u32 buffersBefore, buffersAfter;
+		u32 verticesBefore, verticesAfter;
+		u32 triangles;
+		f32 acmrBefore, acmrAfter; // average cache miss ratio, see getACMR()
+	};
+
+	// Returns an optimized copy of mesh; the caller drops it
+	SMesh* optimize(IMesh* mesh, Stats* stats = nullptr);
+
+	// Vertex cache misses per triangle of a buffer on a 16-entry FIFO cache
+	// (3.0 is the worst case, around 0.6-0.7 is good for typical meshes)
+	f32 getACMR(const IMeshBuffer* buffer);
+}
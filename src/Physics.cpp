@@ -1,12 +1,105 @@
 #include "Physics.h"
+#include "UniformGridBroadphase.h"
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
 
-Physics::Physics()
+static const f32 FIXED_TIME_STEP = 1.0f / 60.0f;
+static const f32 SUBSTEP_COST_SMOOTHING = 0.1f;
+
+// Bullet uses one global task scheduler; create it on first use and keep it
+// for the lifetime of the process (worker threads are reused between worlds).
+static btITaskScheduler* getTaskScheduler()
+{
+	static btITaskScheduler* scheduler = nullptr;
+	if (!scheduler)
+	{
+		scheduler = btCreateDefaultTaskScheduler();
+		if (scheduler)
+			btSetTaskScheduler(scheduler);
+	}
+	return scheduler;
+}
+
+static const char* BROADPHASE_NAMES[] = { "dbvt", "sap", "sap32", "grid" };
+
+const char* getBroadphaseName(BroadphaseType type)
 {
+	return BROADPHASE_NAMES[(int)type];
+}
+
+bool parseBroadphaseName(const char* name, BroadphaseType& out)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		if (strcmp(name, BROADPHASE_NAMES[i]) == 0)
+		{
+			out = (BroadphaseType)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+static btBroadphaseInterface* createBroadphase(const PhysicsConfig& config)
+{
+	btVector3 worldMin = toBullet(config.worldMin);
+	btVector3 worldMax = toBullet(config.worldMax);
+
+	switch (config.broadphase)
+	{
+	case BroadphaseType::AXIS_SWEEP:
+		return new btAxisSweep3(worldMin, worldMax);
+	case BroadphaseType::AXIS_SWEEP_32:
+		return new bt32BitAxisSweep3(worldMin, worldMax);
+	case BroadphaseType::GRID:
+		return new UniformGridBroadphase(worldMin, worldMax, config.gridCellSize);
+	default:
+		return new btDbvtBroadphase();
+	}
+}
+
+Physics::Physics(const PhysicsConfig& config)
+	: m_broadphaseType(config.broadphase)
+	, m_solverPool(nullptr)
+	, m_numThreads(1)
+	, m_stepBudgetMs(config.stepBudgetMs)
+	, m_stats{ 0, 0.0f, 0.0f, 10, 1.0f, false }
+	, m_nextSerial(0)
+	, m_tick(0)
+	, m_snapshots(nullptr)
+	, m_snapshotHead(0)
+	, m_snapshotCount(0)
+	, m_snapshotEntries(nullptr)
+	, m_entryCapacity(0)
+	, m_entryHead(0)
+	, m_entriesUsed(0)
+{
+	btITaskScheduler* scheduler = (config.numThreads > 1) ? getTaskScheduler() : nullptr;
+	if (config.numThreads > 1 && !scheduler)
+		std::cout << "Physics: no task scheduler (Bullet built without BT_THREADSAFE), using 1 thread" << std::endl;
+
 	m_collisionConfig = new btDefaultCollisionConfiguration();
-	m_dispatcher = new btCollisionDispatcher(m_collisionConfig);
-	m_broadphase = new btDbvtBroadphase();
-	m_solver = new btSequentialImpulseConstraintSolver();
-	m_world = new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_collisionConfig);
+	m_broadphase = createBroadphase(config);
+
+	if (scheduler)
+	{
+		m_numThreads = config.numThreads < scheduler->getMaxNumThreads() ? config.numThreads : scheduler->getMaxNumThreads();
+		scheduler->setNumThreads(m_numThreads);
+
+		m_dispatcher = new btCollisionDispatcherMt(m_collisionConfig);
+		m_solverPool = new btConstraintSolverPoolMt(m_numThreads);
+		m_solver = new btSequentialImpulseConstraintSolverMt();
+		m_world = new btDiscreteDynamicsWorldMt(m_dispatcher, m_broadphase, m_solverPool, m_solver, m_collisionConfig);
+	}
+	else
+	{
+		m_dispatcher = new btCollisionDispatcher(m_collisionConfig);
+		m_solver = new btSequentialImpulseConstraintSolver();
+		m_world = new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_collisionConfig);
+	}
 	m_world->setGravity(btVector3(0, -981.0f, 0));
 
 	// Required for btGhostObject overlap detection
@@ -28,14 +121,62 @@ Physics::~Physics()
 
 	delete m_world;
 	delete m_solver;
+	delete m_solverPool;
 	delete m_broadphase;
 	delete m_dispatcher;
 	delete m_collisionConfig;
+	delete[] m_snapshots;
+	delete[] m_snapshotEntries;
+}
+
+int Physics::getSubStepCap(int maxSubSteps) const
+{
+	// Cap substeps by the budget so a slow frame can't make the next one slower
+	// (spiral of death). No measurement yet -> trust the caller's cap.
+	if (m_stats.msPerSubStep <= 0.0f)
+		return maxSubSteps;
+
+	int allowed = (int)(m_stepBudgetMs / m_stats.msPerSubStep);
+	if (allowed < 1) allowed = 1;
+	if (allowed > maxSubSteps) allowed = maxSubSteps;
+	return allowed;
+}
+
+f32 Physics::budgetFrameTime(f32 deltaTime, int maxSubSteps)
+{
+	m_stats.maxSubSteps = getSubStepCap(maxSubSteps);
+
+	f32 maxDelta = m_stats.maxSubSteps * FIXED_TIME_STEP;
+	f32 budgeted = (deltaTime > maxDelta) ? maxDelta : deltaTime;
+
+	m_stats.degraded = budgeted < deltaTime;
+	m_stats.timeScale = (deltaTime > 0.0f) ? budgeted / deltaTime : 1.0f;
+	return budgeted;
 }
 
 void Physics::stepSimulation(f32 deltaTime, int maxSubSteps)
 {
-	m_world->stepSimulation(deltaTime, maxSubSteps);
+	// Anything beyond the cap is dropped rather than accumulated; callers that
+	// want it reported run the frame delta through budgetFrameTime first
+	int cap = getSubStepCap(maxSubSteps);
+	f32 maxDelta = cap * FIXED_TIME_STEP;
+	if (deltaTime > maxDelta)
+		deltaTime = maxDelta;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	int subSteps = m_world->stepSimulation(deltaTime, cap, FIXED_TIME_STEP);
+	f32 ms = std::chrono::duration<f32, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	m_stats.subSteps = subSteps;
+	m_stats.stepMs = ms;
+	if (subSteps > 0)
+	{
+		f32 perStep = ms / subSteps;
+		if (m_stats.msPerSubStep <= 0.0f)
+			m_stats.msPerSubStep = perStep;
+		else
+			m_stats.msPerSubStep += (perStep - m_stats.msPerSubStep) * SUBSTEP_COST_SMOOTHING;
+	}
 }
 
 btRigidBody* Physics::createRigidBody(f32 mass, btCollisionShape* shape, const vector3df& position)
@@ -52,6 +193,7 @@ btRigidBody* Physics::createRigidBody(f32 mass, btCollisionShape* shape, const v
 
 	btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, motionState, shape, localInertia);
 	btRigidBody* body = new btRigidBody(rbInfo);
+	assignSerial(body);
 
 	m_world->addRigidBody(body);
 	return body;
@@ -85,8 +227,11 @@ void Physics::debugDrawWorld()
 void Physics::addGhostObject(btGhostObject* ghost)
 {
 	if (ghost)
+	{
+		assignSerial(ghost);
 		m_world->addCollisionObject(ghost, btBroadphaseProxy::SensorTrigger,
 			btBroadphaseProxy::AllFilter);
+	}
 }
 
 void Physics::removeGhostObject(btGhostObject* ghost)
@@ -146,3 +291,204 @@ Physics::RayResult Physics::rayTest(const vector3df& from, const vector3df& to)
 
 	return result;
 }
+
+void Physics::setSnapshotsEnabled(bool enabled)
+{
+	if (enabled && !m_snapshots)
+	{
+		m_snapshots = new PhysicsSnapshot[PHYSICS_SNAPSHOT_RING_SIZE];
+		m_snapshotEntries = new PhysicsSnapshotEntry[PHYSICS_SNAPSHOT_INITIAL_ENTRIES];
+		m_entryCapacity = PHYSICS_SNAPSHOT_INITIAL_ENTRIES;
+	}
+
+	m_snapshotHead = 0;
+	m_snapshotCount = 0;
+	m_entryHead = 0;
+	m_entriesUsed = 0;
+	m_world->setInternalTickCallback(enabled ? &Physics::onInternalTick : nullptr, this);
+}
+
+void Physics::onInternalTick(btDynamicsWorld* world, btScalar timeStep)
+{
+	Physics* self = static_cast<Physics*>(world->getWorldUserInfo());
+	self->m_tick++;
+	self->captureSnapshot();
+}
+
+// Only reached when a full ring of ticks no longer fits, so the pool settles
+// at the ring size times the live object count and stops allocating
+void Physics::growSnapshotEntries(u32 needed)
+{
+	u32 capacity = m_entryCapacity;
+	while (capacity < needed)
+		capacity *= 2;
+
+	// Unwrap the live entries, oldest first, and repoint the snapshots
+	PhysicsSnapshotEntry* entries = new PhysicsSnapshotEntry[capacity];
+	u32 written = 0;
+	for (int back = m_snapshotCount - 1; back >= 0; back--)
+	{
+		PhysicsSnapshot& snapshot = m_snapshots[(m_snapshotHead - 1 - back + PHYSICS_SNAPSHOT_RING_SIZE) % PHYSICS_SNAPSHOT_RING_SIZE];
+		for (u32 n = 0; n < snapshot.count; n++)
+			entries[written + n] = getSnapshotEntry(snapshot, n);
+		snapshot.first = written;
+		written += snapshot.count;
+	}
+
+	delete[] m_snapshotEntries;
+	m_snapshotEntries = entries;
+	m_entryCapacity = capacity;
+	m_entryHead = written % capacity;
+}
+
+void Physics::captureSnapshot()
+{
+	const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+	u32 count = 0;
+	for (int i = 0; i < objects.size(); i++)
+	{
+		const btRigidBody* body = btRigidBody::upcast(objects[i]);
+		if (btGhostObject::upcast(objects[i]) || (body && !body->isStaticObject()))
+			count++;
+	}
+
+	// A full ring frees its oldest tick; if the rest plus this tick still
+	// overflow the pool, the pool grows instead of dropping more history
+	if (m_snapshotCount == PHYSICS_SNAPSHOT_RING_SIZE)
+	{
+		m_entriesUsed -= m_snapshots[m_snapshotHead].count;
+		m_snapshotCount--;
+	}
+	if (m_entriesUsed + count > m_entryCapacity)
+		growSnapshotEntries(m_entriesUsed + count);
+
+	PhysicsSnapshot& out = m_snapshots[m_snapshotHead];
+	out.version = PHYSICS_SNAPSHOT_VERSION;
+	out.tick = m_tick;
+	out.first = m_entryHead;
+	out.count = count;
+
+	u32 n = 0;
+	for (int i = 0; i < objects.size() && n < count; i++)
+	{
+		const btCollisionObject* obj = objects[i];
+		const btRigidBody* body = btRigidBody::upcast(obj);
+		bool isTrigger = btGhostObject::upcast(obj) != nullptr;
+		if (!isTrigger && (!body || body->isStaticObject()))
+			continue;
+
+		PhysicsSnapshotEntry& e = m_snapshotEntries[(out.first + n++) % m_entryCapacity];
+		e.object = obj;
+		e.serial = obj->getUserIndex3();
+		e.worldIndex = i;
+
+		const btTransform& t = obj->getWorldTransform();
+		btQuaternion q = t.getRotation();
+		e.origin[0] = t.getOrigin().getX();
+		e.origin[1] = t.getOrigin().getY();
+		e.origin[2] = t.getOrigin().getZ();
+		e.rotation[0] = q.getX();
+		e.rotation[1] = q.getY();
+		e.rotation[2] = q.getZ();
+		e.rotation[3] = q.getW();
+
+		btVector3 lin = body ? body->getLinearVelocity() : btVector3(0, 0, 0);
+		btVector3 ang = body ? body->getAngularVelocity() : btVector3(0, 0, 0);
+		e.linearVelocity[0] = lin.getX();
+		e.linearVelocity[1] = lin.getY();
+		e.linearVelocity[2] = lin.getZ();
+		e.angularVelocity[0] = ang.getX();
+		e.angularVelocity[1] = ang.getY();
+		e.angularVelocity[2] = ang.getZ();
+	}
+
+	m_entryHead = (m_entryHead + count) % m_entryCapacity;
+	m_entriesUsed += count;
+	m_snapshotHead = (m_snapshotHead + 1) % PHYSICS_SNAPSHOT_RING_SIZE;
+	m_snapshotCount++;
+}
+
+void Physics::restoreSnapshot(const PhysicsSnapshot& snapshot)
+{
+	if (snapshot.version != PHYSICS_SNAPSHOT_VERSION)
+		return;
+
+	btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+	for (u32 n = 0; n < snapshot.count; n++)
+	{
+		const PhysicsSnapshotEntry& e = getSnapshotEntry(snapshot, n);
+
+		// Only dereference objects that are still in the world
+		btCollisionObject* obj = nullptr;
+		if (e.worldIndex < objects.size() && objects[e.worldIndex] == e.object)
+			obj = objects[e.worldIndex];
+		else
+		{
+			int found = objects.findLinearSearch(const_cast<btCollisionObject*>(e.object));
+			if (found < objects.size())
+				obj = objects[found];
+		}
+		if (!obj || obj->getUserIndex3() != e.serial)
+			continue;
+
+		btTransform t;
+		t.setOrigin(btVector3(e.origin[0], e.origin[1], e.origin[2]));
+		t.setRotation(btQuaternion(e.rotation[0], e.rotation[1], e.rotation[2], e.rotation[3]));
+		obj->setWorldTransform(t);
+
+		btRigidBody* body = btRigidBody::upcast(obj);
+		if (body)
+		{
+			body->setInterpolationWorldTransform(t);
+			if (body->getMotionState())
+				body->getMotionState()->setWorldTransform(t);
+			body->setLinearVelocity(btVector3(e.linearVelocity[0], e.linearVelocity[1], e.linearVelocity[2]));
+			body->setAngularVelocity(btVector3(e.angularVelocity[0], e.angularVelocity[1], e.angularVelocity[2]));
+			body->setInterpolationLinearVelocity(body->getLinearVelocity());
+			body->setInterpolationAngularVelocity(body->getAngularVelocity());
+			body->clearForces();
+			// A body asleep now but moving in the snapshot has to simulate again
+			body->activate(true);
+		}
+		// The broadphase proxy still has the AABB of the current position
+		m_world->updateSingleAabb(obj);
+	}
+	m_tick = snapshot.tick;
+}
+
+const PhysicsSnapshot* Physics::getSnapshot(int ticksBack) const
+{
+	if (!m_snapshots || ticksBack < 0 || ticksBack >= m_snapshotCount)
+		return nullptr;
+
+	int slot = (m_snapshotHead - 1 - ticksBack + PHYSICS_SNAPSHOT_RING_SIZE) % PHYSICS_SNAPSHOT_RING_SIZE;
+	return &m_snapshots[slot];
+}
+
+bool Physics::rewind(int ticksBack)
+{
+	if (ticksBack >= m_snapshotCount)
+		ticksBack = m_snapshotCount - 1;
+
+	const PhysicsSnapshot* snapshot = getSnapshot(ticksBack);
+	if (!snapshot)
+		return false;
+
+	restoreSnapshot(*snapshot);
+
+	// The restored tick becomes the newest one; ticks after it are dropped
+	// and their entries go back to the pool
+	for (int back = 0; back < ticksBack; back++)
+		m_entriesUsed -= getSnapshot(back)->count;
+	m_entryHead = (snapshot->first + snapshot->count) % m_entryCapacity;
+	m_snapshotHead = (m_snapshotHead - ticksBack + PHYSICS_SNAPSHOT_RING_SIZE) % PHYSICS_SNAPSHOT_RING_SIZE;
+	m_snapshotCount -= ticksBack;
+	return true;
+}
+
+u32 Physics::getSnapshotMemory() const
+{
+	if (!m_snapshots)
+		return 0;
+	return PHYSICS_SNAPSHOT_RING_SIZE * sizeof(PhysicsSnapshot) + m_entryCapacity * sizeof(PhysicsSnapshotEntry);
+}
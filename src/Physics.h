@@ -1,6 +1,7 @@
 #pragma once
 #include <btBulletDynamicsCommon.h>
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 #include <irrlicht.h>
 
 using namespace irr;
@@ -9,13 +10,85 @@ using namespace core;
 inline btVector3 toBullet(const vector3df& v) { return btVector3(v.X, v.Y, v.Z); }
 inline vector3df toIrrlicht(const btVector3& v) { return vector3df(v.getX(), v.getY(), v.getZ()); }
 
+enum class BroadphaseType
+{
+	DBVT,          // btDbvtBroadphase, unbounded
+	AXIS_SWEEP,    // btAxisSweep3, 16-bit quantized to the world bounds
+	AXIS_SWEEP_32, // bt32BitAxisSweep3, 32-bit quantized to the world bounds
+	GRID           // UniformGridBroadphase over the world bounds
+};
+
+struct PhysicsConfig
+{
+	// 1 = btDiscreteDynamicsWorld, >1 = btDiscreteDynamicsWorldMt with a solver pool.
+	// Falls back to single-threaded if Bullet was built without BT_THREADSAFE.
+	int numThreads = 1;
+
+	// Wall-clock budget for the physics substeps of one frame. The number of
+	// 1/60 s substeps is capped to what fits, based on the measured cost.
+	f32 stepBudgetMs = 5.0f;
+
+	// Broadphase and the bounds used by the bounded ones (sweep-and-prune, grid).
+	// Game sets the bounds from the arena size; objects outside still collide
+	// but lose precision (sweep-and-prune) or pile into the edge cells (grid).
+	BroadphaseType broadphase = BroadphaseType::DBVT;
+	vector3df worldMin = vector3df(-2000.0f, -200.0f, -2000.0f);
+	vector3df worldMax = vector3df(2000.0f, 800.0f, 2000.0f);
+	f32 gridCellSize = 100.0f;
+};
+
+const char* getBroadphaseName(BroadphaseType type);
+bool parseBroadphaseName(const char* name, BroadphaseType& out);
+
+struct PhysicsStats
+{
+	int  subSteps;       // substeps run last frame
+	f32  stepMs;         // wall-clock time of the last stepSimulation
+	f32  msPerSubStep;   // smoothed cost of one substep
+	int  maxSubSteps;    // substep cap from the budget
+	f32  timeScale;      // simulated / real time, < 1 when degraded
+	bool degraded;       // frame time exceeded the budget and was slowed down
+};
+
+// Record of every dynamic body and trigger at one physics tick. Entries are
+// plain data and only as many as there were live objects; all ticks share
+// one circular entry pool, and a snapshot is just its slice of that pool.
+// Objects are matched back by pointer + serial, so bodies that were removed
+// since the capture are skipped on restore.
+static const u32 PHYSICS_SNAPSHOT_VERSION = 2;
+static const int PHYSICS_SNAPSHOT_RING_SIZE = 300; // 5 s of 1/60 s ticks
+static const u32 PHYSICS_SNAPSHOT_INITIAL_ENTRIES = PHYSICS_SNAPSHOT_RING_SIZE * 32;
+
+struct PhysicsSnapshotEntry
+{
+	const btCollisionObject* object;
+	s32 serial;
+	s32 worldIndex;
+	f32 origin[3];
+	f32 rotation[4];
+	f32 linearVelocity[3];
+	f32 angularVelocity[3];
+};
+
+struct PhysicsSnapshot
+{
+	u32 version;
+	u32 tick;
+	u32 first;  // pool index of the first entry; entries may wrap around
+	u32 count;
+};
+
 class Physics
 {
 public:
-	Physics();
+	Physics(const PhysicsConfig& config = PhysicsConfig());
 	~Physics();
 
+	// Clamps a frame delta to what the substep budget can simulate. Game runs
+	// its own timers on the result so gameplay slows together with physics.
+	f32 budgetFrameTime(f32 deltaTime, int maxSubSteps = 10);
 	void stepSimulation(f32 deltaTime, int maxSubSteps = 10);
+	const PhysicsStats& getStats() const { return m_stats; }
 
 	btRigidBody* createRigidBody(f32 mass, btCollisionShape* shape, const vector3df& position);
 	void removeRigidBody(btRigidBody* body);
@@ -37,12 +110,49 @@ public:
 	void setDebugDrawer(btIDebugDraw* drawer);
 	void debugDrawWorld();
 
+	// Snapshot ring: when enabled, every internal tick is captured
+	void setSnapshotsEnabled(bool enabled);
+	void restoreSnapshot(const PhysicsSnapshot& snapshot);
+	// Rewinds to the tick captured ticksBack ticks ago; later ticks are dropped
+	bool rewind(int ticksBack);
+	int getSnapshotCount() const { return m_snapshotCount; }
+	const PhysicsSnapshot* getSnapshot(int ticksBack) const;
+	const PhysicsSnapshotEntry& getSnapshotEntry(const PhysicsSnapshot& snapshot, u32 n) const
+	{
+		return m_snapshotEntries[(snapshot.first + n) % m_entryCapacity];
+	}
+	// Bytes held by the ring and its entry pool
+	u32 getSnapshotMemory() const;
+
 	btDiscreteDynamicsWorld* getWorld() { return m_world; }
+	int getNumThreads() const { return m_numThreads; }
+	BroadphaseType getBroadphaseType() const { return m_broadphaseType; }
 
 private:
+	int getSubStepCap(int maxSubSteps) const;
+	void assignSerial(btCollisionObject* obj) { obj->setUserIndex3(++m_nextSerial); }
+	static void onInternalTick(btDynamicsWorld* world, btScalar timeStep);
+	void captureSnapshot();
+	void growSnapshotEntries(u32 needed);
+
 	btDefaultCollisionConfiguration*     m_collisionConfig;
 	btCollisionDispatcher*               m_dispatcher;
 	btBroadphaseInterface*               m_broadphase;
-	btSequentialImpulseConstraintSolver*  m_solver;
+	BroadphaseType                       m_broadphaseType;
+	btConstraintSolver*                  m_solver;
+	btConstraintSolverPoolMt*            m_solverPool;
 	btDiscreteDynamicsWorld*             m_world;
+	int                                  m_numThreads;
+	f32                                  m_stepBudgetMs;
+	PhysicsStats                         m_stats;
+
+	s32                                  m_nextSerial;
+	u32                                  m_tick;
+	PhysicsSnapshot*                     m_snapshots;     // ring, allocated once
+	int                                  m_snapshotHead;  // next slot to write
+	int                                  m_snapshotCount;
+	PhysicsSnapshotEntry*                m_snapshotEntries; // circular pool behind the ring
+	u32                                  m_entryCapacity;
+	u32                                  m_entryHead;     // next entry to write
+	u32                                  m_entriesUsed;   // held by the live snapshots
 };
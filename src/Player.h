@@ -62,7 +62,6 @@ private:
 	Physics* m_physics;
 	IAnimatedMeshSceneNode* m_playerNode;
 	IAnimatedMeshSceneNode* m_weaponNode;
-	ISceneNode* m_shadowNode;
 
 	f32 m_rotationY;
 	vector3df m_forward;
@@ -0,0 +1,53 @@
+#include "QuadBatch.h"
+
+namespace QuadBatch
+{
+	ITexture* createRoundTexture(IVideoDriver* driver, const io::path& name, u32 size,
+		SColor color, u32 falloffPower)
+	{
+		IImage* img = driver->createImage(ECF_A8R8G8B8, dimension2d<u32>(size, size));
+		const f32 center = size / 2.0f;
+		const f32 radius = center - 1.0f;
+		for (u32 y = 0; y < size; ++y)
+			for (u32 x = 0; x < size; ++x)
+			{
+				f32 dx = x - center, dy = y - center;
+				f32 falloff = 1.0f - (dx * dx + dy * dy) / (radius * radius);
+				f32 alpha = 0.0f;
+				if (falloff > 0.0f)
+				{
+					alpha = (f32)color.getAlpha();
+					for (u32 p = 0; p < falloffPower; ++p)
+						alpha *= falloff;
+				}
+				img->setPixel(x, y, SColor((u32)alpha, color.getRed(), color.getGreen(), color.getBlue()));
+			}
+		ITexture* texture = driver->addTexture(name, img);
+		img->drop();
+		return texture;
+	}
+
+	u32 draw(IVideoDriver* driver, const SMaterial& material,
+		const array<S3DVertex>& vertices, array<u16>& indices)
+	{
+		const u32 quads = vertices.size() / 4;
+		if (quads == 0)
+			return 0;
+
+		for (u32 q = indices.size() / 6; q < quads; q++)
+		{
+			const u16 base = (u16)(q * 4);
+			indices.push_back(base);
+			indices.push_back(base + 1);
+			indices.push_back(base + 2);
+			indices.push_back(base);
+			indices.push_back(base + 2);
+			indices.push_back(base + 3);
+		}
+
+		driver->setTransform(ETS_WORLD, IdentityMatrix);
+		driver->setMaterial(material);
+		driver->drawIndexedTriangleList(vertices.const_pointer(), vertices.size(), indices.const_pointer(), quads * 2);
+		return quads;
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Shared pieces of the nodes that draw many textured quads in one call
+// (blob shadows, fog clouds): a procedural round texture, and drawing a
+// vertex list of quads, four corners each, as one indexed triangle list.
+namespace QuadBatch
+{
+	// Square texture of the given color, opaque as color's alpha at the
+	// center and fading to 0 at the edge as (1 - d^2)^falloffPower, with d
+	// the distance from the center over the radius
+	ITexture* createRoundTexture(IVideoDriver* driver, const io::path& name, u32 size,
+		SColor color, u32 falloffPower);
+
+	// Draws vertices as quads with identity world transform. The index
+	// pattern only depends on the quad count, so indices is kept by the
+	// caller and grown on demand. Returns the number of quads drawn.
+	u32 draw(IVideoDriver* driver, const SMaterial& material,
+		const array<S3DVertex>& vertices, array<u16>& indices);
+}
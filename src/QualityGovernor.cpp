@@ -0,0 +1,158 @@
+#include "QualityGovernor.h"
+#include <cstdarg>
+#include <cwchar>
+
+// Average over the budget by this much for DOWNGRADE_HOLD seconds steps down;
+// under UPGRADE_RATIO of it for the upgrade hold steps back up
+static const f32 DOWNGRADE_RATIO = 1.15f;
+static const f32 UPGRADE_RATIO = 0.7f;
+static const f32 DOWNGRADE_HOLD = 0.5f;
+static const f32 UPGRADE_HOLD = 3.0f;
+static const f32 MAX_UPGRADE_HOLD = 24.0f;
+
+// Stepping down this soon after stepping up means the upgrade didn't fit
+static const f32 FAILED_UPGRADE_WINDOW = 5.0f;
+
+// A single hitch (loading, alt-tab) counts as at most this many budgets
+static const f32 MAX_SAMPLE_RATIO = 4.0f;
+
+QualityGovernor::QualityGovernor(const QualityTier* tiers, u32 tierCount, f32 targetFrameTime)
+	: m_tiers(tiers)
+	, m_tierCount(tierCount)
+	, m_tier(0)
+	, m_previousTier(0)
+	, m_changeCount(0)
+	, m_changeAverage(0.0f)
+	, m_target(targetFrameTime)
+	, m_enabled(true)
+{
+	reset();
+	m_upgradeHold = UPGRADE_HOLD;
+}
+
+void QualityGovernor::reset()
+{
+	m_sampleCount = 0;
+	m_nextSample = 0;
+	m_sum = 0.0f;
+	m_overTime = 0.0f;
+	m_underTime = 0.0f;
+	m_sinceChange = 0.0f;
+}
+
+f32 QualityGovernor::getAverageFrameTime() const
+{
+	return m_sampleCount ? m_sum / m_sampleCount : 0.0f;
+}
+
+bool QualityGovernor::update(f32 frameTime)
+{
+	if (!m_enabled)
+		return false;
+
+	frameTime = core::min_(frameTime, m_target * MAX_SAMPLE_RATIO);
+	if (m_sampleCount == WINDOW)
+		m_sum -= m_samples[m_nextSample];
+	else
+		m_sampleCount++;
+	m_samples[m_nextSample] = frameTime;
+	m_sum += frameTime;
+	m_nextSample = (m_nextSample + 1) % WINDOW;
+	m_sinceChange += frameTime;
+
+	// Judge a tier only on frames rendered with it
+	if (m_sampleCount < WINDOW)
+		return false;
+
+	const f32 average = getAverageFrameTime();
+	if (average > m_target * DOWNGRADE_RATIO)
+	{
+		m_overTime += frameTime;
+		m_underTime = 0.0f;
+	}
+	else if (average < m_target * UPGRADE_RATIO)
+	{
+		m_underTime += frameTime;
+		m_overTime = 0.0f;
+	}
+	else
+	{
+		m_overTime = 0.0f;
+		m_underTime = 0.0f;
+	}
+
+	if (m_overTime >= DOWNGRADE_HOLD && m_tier + 1 < m_tierCount)
+	{
+		const bool lastWasUpgrade = m_changeCount > 0 && m_previousTier > m_tier;
+		if (lastWasUpgrade && m_sinceChange < FAILED_UPGRADE_WINDOW)
+			m_upgradeHold = core::min_(m_upgradeHold * 2.0f, MAX_UPGRADE_HOLD);
+		setTier(m_tier + 1);
+		return true;
+	}
+	if (m_underTime >= m_upgradeHold && m_tier > 0)
+	{
+		setTier(m_tier - 1);
+		return true;
+	}
+	return false;
+}
+
+void QualityGovernor::setTier(u32 tier)
+{
+	m_previousTier = m_tier;
+	m_tier = tier;
+	m_changeCount++;
+	m_changeAverage = getAverageFrameTime();
+	reset();
+}
+
+static const wchar_t* shadowName(const QualityTier& t)
+{
+	if (!t.shadows)
+		return L"off";
+	return t.stencilShadows ? L"stencil" : L"blob";
+}
+
+// Appends to out at n; a string that does not fit is dropped
+static void append(wchar_t* out, u32 size, s32& n, const wchar_t* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	const s32 written = vswprintf(out + n, size - n, format, args);
+	va_end(args);
+	if (written > 0)
+		n += written;
+	else
+		out[n] = 0;
+}
+
+void QualityGovernor::describeLastChange(wchar_t* out, u32 size) const
+{
+	if (m_changeCount == 0)
+	{
+		swprintf(out, size, L"none");
+		return;
+	}
+
+	const QualityTier& a = m_tiers[m_previousTier];
+	const QualityTier& b = m_tiers[m_tier];
+	s32 n = 0;
+	append(out, size, n, L"%ls -> %ls:", a.name, b.name);
+
+	// Only the knobs that differ between the two tiers
+	if (a.shadows != b.shadows || a.stencilShadows != b.stencilShadows)
+		append(out, size, n, L" shadows %ls,", shadowName(b));
+	if (a.animLodDistance != b.animLodDistance)
+		append(out, size, n, L" anim LOD %.0f,", b.animLodDistance);
+	if (a.impostorDistance != b.impostorDistance)
+		append(out, size, n, L" impostors %.0f,", b.impostorDistance);
+	if (a.farValue != b.farValue)
+		append(out, size, n, L" far %.0f,", b.farValue);
+	if (a.debugNearPlayerOnly != b.debugNearPlayerOnly)
+		append(out, size, n, L" wireframe %ls,", b.debugNearPlayerOnly ? L"near player" : L"all");
+	if (a.maxFullDetailEnemies != b.maxFullDetailEnemies)
+		append(out, size, n, L" full-detail %u,", b.maxFullDetailEnemies);
+
+	if (n > 0 && out[n - 1] == L',')
+		out[n - 1] = 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+
+// One step of the quality ladder. Tier 0 is the best looking one; every
+// following tier gives up something to render faster.
+struct QualityTier
+{
+	const wchar_t* name;
+	bool stencilShadows;        // enemies cast stencil volumes (if enabled at startup)
+	bool shadows;               // false hides blob shadows as well
+	f32  animLodDistance;       // enemies further than this animate at the reduced rate
+	f32  impostorDistance;      // enemies further than this become billboards
+	f32  farValue;              // camera far plane / map draw distance
+	bool debugNearPlayerOnly;   // physics wireframe (F1) only around the player
+	u32  maxFullDetailEnemies;  // nearest N animate at full rate, the rest reduced
+};
+
+// Keeps a rolling average of frame times and walks the tier ladder to hold
+// the target frame time. Stepping down needs the average to stay above the
+// budget for a short while, stepping up needs clear headroom for much longer,
+// and each tier change restarts the measurement, so the tier does not
+// oscillate around the budget. An upgrade that has to be undone right away
+// makes the next upgrade attempt wait longer.
+class QualityGovernor
+{
+public:
+	QualityGovernor(const QualityTier* tiers, u32 tierCount, f32 targetFrameTime);
+
+	// Feed the unclamped frame time in seconds; returns true when the tier changed
+	bool update(f32 frameTime);
+	// Drops the measured history, e.g. after loading or leaving a menu
+	void reset();
+
+	void setEnabled(bool enabled) { m_enabled = enabled; }
+	bool isEnabled() const { return m_enabled; }
+
+	const QualityTier& getTier() const { return m_tiers[m_tier]; }
+	u32 getTierIndex() const { return m_tier; }
+	u32 getTierCount() const { return m_tierCount; }
+	f32 getTargetFrameTime() const { return m_target; }
+	f32 getAverageFrameTime() const;
+
+	// Last tier change and the knobs it turned, for the debug overlay
+	u32 getChangeCount() const { return m_changeCount; }
+	u32 getPreviousTierIndex() const { return m_previousTier; }
+	f32 getChangeFrameTime() const { return m_changeAverage; } // average that triggered it
+	void describeLastChange(wchar_t* out, u32 size) const;
+
+private:
+	void setTier(u32 tier);
+
+	static const u32 WINDOW = 30;
+
+	const QualityTier* m_tiers;
+	u32  m_tierCount;
+	u32  m_tier;
+	u32  m_previousTier;
+	u32  m_changeCount;
+	f32  m_changeAverage;
+	f32  m_target;
+	bool m_enabled;
+
+	f32  m_samples[WINDOW];
+	u32  m_sampleCount;
+	u32  m_nextSample;
+	f32  m_sum;
+
+	f32  m_overTime;      // seconds the average has been over the budget
+	f32  m_underTime;     // seconds it has been well under it
+	f32  m_sinceChange;   // seconds since the last tier change
+	f32  m_upgradeHold;   // headroom needed this long before stepping up
+};
@@ -0,0 +1,121 @@
+#include "SkinPreviewRenderer.h"
+#include <cmath>
+
+static const u32 PREVIEW_SIZE = 512;
+static const vector3df PREVIEW_CAMERA_POS(0, 40, -150);
+static const vector3df PREVIEW_CAMERA_TARGET(0, 20, 0);
+
+SkinPreviewRenderer::SkinPreviewRenderer(ISceneManager* smgr)
+	: m_driver(smgr->getVideoDriver())
+	, m_scene(smgr->createNewSceneManager(false))
+	, m_camera(nullptr)
+	, m_target(nullptr)
+	, m_skin(0)
+	, m_rotation(0)
+	, m_renderedSkin(-1)
+	, m_renderedRotation(0)
+	, m_renderCount(0)
+{
+	const dimension2du ss = m_driver->getScreenSize();
+	const s32 size = (s32)core::min_(PREVIEW_SIZE, core::min_(ss.Width, ss.Height));
+	m_screenRect = rect<s32>((ss.Width - size) / 2, (ss.Height - size) / 2,
+		(ss.Width - size) / 2 + size, (ss.Height - size) / 2 + size);
+
+	if (m_driver->queryFeature(EVDF_RENDER_TO_TARGET))
+	{
+		m_target = m_driver->addRenderTargetTexture(dimension2du(size, size), "skin_preview", ECF_A8R8G8B8);
+		if (m_target)
+			m_target->grab();
+	}
+
+	// Narrow the full screen field of view down to the centered square
+	m_camera = m_scene->addCameraSceneNode(0, PREVIEW_CAMERA_POS, PREVIEW_CAMERA_TARGET);
+	const f32 fullFovy = m_camera->getFOV();
+	m_camera->setFOV(2.0f * atanf(tanf(fullFovy * 0.5f) * size / ss.Height));
+	m_camera->setAspectRatio(1.0f);
+}
+
+SkinPreviewRenderer::~SkinPreviewRenderer()
+{
+	m_scene->drop();
+	if (m_target)
+	{
+		m_driver->removeTexture(m_target);
+		m_target->drop();
+	}
+}
+
+void SkinPreviewRenderer::addSkin(IAnimatedMesh* mesh, ITexture* texture, IAnimatedMesh* weaponMesh, ITexture* weaponTexture)
+{
+	// Pivot node for rotation
+	ISceneNode* pivot = m_scene->addEmptySceneNode();
+	pivot->setVisible(false);
+	m_pivots.push_back(pivot);
+
+	if (!mesh)
+		return;
+
+	IAnimatedMeshSceneNode* model = m_scene->addAnimatedMeshSceneNode(mesh, pivot);
+	model->setMaterialTexture(0, texture);
+	model->setMaterialFlag(EMF_LIGHTING, false);
+	model->setMD2Animation(EMAT_STAND);
+
+	if (weaponMesh)
+	{
+		IAnimatedMeshSceneNode* weapon = m_scene->addAnimatedMeshSceneNode(weaponMesh, model);
+		weapon->setMaterialTexture(0, weaponTexture);
+		weapon->setMaterialFlag(EMF_LIGHTING, false);
+		weapon->setMD2Animation(EMAT_STAND);
+	}
+}
+
+void SkinPreviewRenderer::setSkin(s32 skin)
+{
+	m_skin = skin;
+}
+
+void SkinPreviewRenderer::setRotation(f32 degrees)
+{
+	m_rotation = (s32)floorf(degrees + 0.5f);
+}
+
+void SkinPreviewRenderer::render()
+{
+	for (u32 i = 0; i < m_pivots.size(); i++)
+	{
+		m_pivots[i]->setVisible((s32)i == m_skin);
+		m_pivots[i]->setRotation(vector3df(0, (f32)m_rotation, 0));
+	}
+	m_scene->drawAll();
+	m_renderCount++;
+}
+
+void SkinPreviewRenderer::draw()
+{
+	if (m_skin < 0 || m_skin >= (s32)m_pivots.size())
+		return;
+
+	if (!m_target)
+	{
+		const rect<s32> oldViewPort = m_driver->getViewPort();
+		m_driver->setViewPort(m_screenRect);
+		render();
+		m_driver->setViewPort(oldViewPort);
+		return;
+	}
+
+	if (m_skin != m_renderedSkin || m_rotation != m_renderedRotation)
+	{
+		const rect<s32> oldViewPort = m_driver->getViewPort();
+		m_driver->setRenderTarget(m_target, true, true, SColor(0, 0, 0, 0));
+		render();
+		m_driver->setRenderTarget(0, false, false);
+		m_driver->setViewPort(oldViewPort);
+
+		m_renderedSkin = m_skin;
+		m_renderedRotation = m_rotation;
+	}
+
+	const dimension2du ts = m_target->getSize();
+	m_driver->draw2DImage(m_target, m_screenRect, rect<s32>(0, 0, ts.Width, ts.Height), 0, 0, true);
+}
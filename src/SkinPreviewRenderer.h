@@ -0,0 +1,48 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Player skin previews for the Customize screen. The models live in their
+// own scene manager, so a preview frame never touches the arena scene, and
+// are rendered into a texture that is only redrawn when the shown skin or
+// its rotation (in whole degrees) changes; otherwise the cached texture is
+// blitted. The view matches the old full screen camera on the centered
+// square the texture covers. Without render target support the preview
+// scene is drawn straight into that square every frame.
+class SkinPreviewRenderer
+{
+public:
+	SkinPreviewRenderer(ISceneManager* smgr);
+	~SkinPreviewRenderer();
+
+	void addSkin(IAnimatedMesh* mesh, ITexture* texture, IAnimatedMesh* weaponMesh, ITexture* weaponTexture);
+
+	void setSkin(s32 skin);
+	void setRotation(f32 degrees);
+
+	// Re-renders the texture if needed and draws it; call between beginScene() and endScene()
+	void draw();
+
+	u32 getRenderCount() const { return m_renderCount; }
+	void resetRenderCount() { m_renderCount = 0; }
+
+private:
+	void render();
+
+	IVideoDriver*     m_driver;
+	ISceneManager*    m_scene;
+	ICameraSceneNode* m_camera;
+	ITexture*         m_target;
+	rect<s32>         m_screenRect;
+	array<ISceneNode*> m_pivots;
+
+	s32 m_skin;
+	s32 m_rotation;      // whole degrees
+	s32 m_renderedSkin;
+	s32 m_renderedRotation;
+	u32 m_renderCount;
+};
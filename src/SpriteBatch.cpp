@@ -0,0 +1,279 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+static const u32 ATLAS_PAGE_SIZE = 2048;
+static const s32 ATLAS_PADDING = 2;
+static const s32 WHITE_BLOCK_SIZE = 4; // solid rectangles sample its center
+static const u32 MAX_BATCH_QUADS = 65536 / 4; // 16-bit indices
+
+SpriteBatch::SpriteBatch(IVideoDriver* driver)
+	: m_driver(driver)
+	, m_currentPage(-1)
+	, m_whitePage(-1)
+	, m_quads(0)
+	, m_binds(0)
+	, m_lastQuads(0)
+	, m_lastBinds(0)
+{
+	// Same blending as draw2DImage with alpha channel and a modulating color
+	m_material.MaterialType = EMT_ONETEXTURE_BLEND;
+	m_material.MaterialTypeParam = pack_textureBlendFunc(EBF_SRC_ALPHA, EBF_ONE_MINUS_SRC_ALPHA,
+		EMFN_MODULATE_1X, EAS_TEXTURE | EAS_VERTEX_COLOR);
+	m_material.Lighting = false;
+	m_material.BackfaceCulling = false;
+	m_material.ZBuffer = ECFN_NEVER;
+	m_material.ZWriteEnable = false;
+	m_material.UseMipMaps = false;
+	m_material.TextureLayer[0].BilinearFilter = false; // the button pack is pixel art
+	m_material.TextureLayer[0].TextureWrapU = ETC_CLAMP_TO_EDGE;
+	m_material.TextureLayer[0].TextureWrapV = ETC_CLAMP_TO_EDGE;
+}
+
+SpriteBatch::~SpriteBatch()
+{
+	for (u32 i = 0; i < m_pages.size(); i++)
+		if (m_pages[i].atlas)
+			m_driver->removeTexture(m_pages[i].texture);
+}
+
+s32 SpriteBatch::add(const io::path& file)
+{
+	for (u32 i = 0; i < m_sprites.size(); i++)
+		if (m_sprites[i].file == file)
+			return i;
+
+	Sprite sprite;
+	sprite.file = file;
+	sprite.page = -1;
+	m_sprites.push_back(sprite);
+	return m_sprites.size() - 1;
+}
+
+void SpriteBatch::build()
+{
+	std::vector<IImage*> images(m_sprites.size(), nullptr);
+	std::vector<u32> order;
+	for (u32 i = 0; i < m_sprites.size(); i++)
+	{
+		images[i] = m_driver->createImageFromFile(m_sprites[i].file);
+		if (!images[i])
+			continue;
+		m_sprites[i].size = images[i]->getDimension();
+		order.push_back(i);
+	}
+
+	// Shelf packing, tallest first
+	std::sort(order.begin(), order.end(), [&](u32 a, u32 b)
+	{
+		return m_sprites[a].size.Height > m_sprites[b].size.Height;
+	});
+
+	const dimension2du maxSize = m_driver->getMaxTextureSize();
+	const u32 pageSize = core::min_(ATLAS_PAGE_SIZE, core::min_(maxSize.Width, maxSize.Height));
+
+	const s32 firstPage = m_pages.size();
+	array<IImage*> pageImages;
+	s32 x = 0, y = 0, shelfHeight = 0;
+	for (u32 i : order)
+	{
+		Sprite& sprite = m_sprites[i];
+		const s32 w = sprite.size.Width + ATLAS_PADDING;
+		const s32 h = sprite.size.Height + ATLAS_PADDING;
+		if (w > (s32)pageSize || h > (s32)pageSize)
+		{
+			std::cout << "SpriteBatch: " << sprite.file.c_str() << " is larger than an atlas page" << std::endl;
+			continue;
+		}
+
+		if (!pageImages.empty() && x + w > (s32)pageSize)
+		{
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (pageImages.empty() || y + h > (s32)pageSize)
+		{
+			IImage* page = m_driver->createImage(ECF_A8R8G8B8, dimension2du(pageSize, pageSize));
+			page->fill(SColor(0, 0, 0, 0));
+			for (s32 py = 0; py < WHITE_BLOCK_SIZE; py++)
+				for (s32 px = 0; px < WHITE_BLOCK_SIZE; px++)
+					page->setPixel(px, py, SColor(255, 255, 255, 255));
+			pageImages.push_back(page);
+
+			x = WHITE_BLOCK_SIZE + ATLAS_PADDING;
+			y = 0;
+			shelfHeight = WHITE_BLOCK_SIZE + ATLAS_PADDING;
+		}
+
+		images[i]->copyTo(pageImages.getLast(), position2d<s32>(x, y));
+		sprite.page = firstPage + pageImages.size() - 1;
+		sprite.uv = rect<f32>((f32)x / pageSize, (f32)y / pageSize,
+			(f32)(x + sprite.size.Width) / pageSize, (f32)(y + sprite.size.Height) / pageSize);
+
+		x += w;
+		shelfHeight = core::max_(shelfHeight, h);
+	}
+
+	for (IImage* image : images)
+		if (image)
+			image->drop();
+
+	// Sprites are drawn at their own size or larger; mip maps would only cost memory
+	const bool mipMaps = m_driver->getTextureCreationFlag(ETCF_CREATE_MIP_MAPS);
+	m_driver->setTextureCreationFlag(ETCF_CREATE_MIP_MAPS, false);
+	for (u32 i = 0; i < pageImages.size(); i++)
+	{
+		Page page;
+		page.texture = m_driver->addTexture(io::path("sprite_atlas_") + io::path(i), pageImages[i]);
+		page.whiteUV = vector2df(WHITE_BLOCK_SIZE * 0.5f / pageSize, WHITE_BLOCK_SIZE * 0.5f / pageSize);
+		page.atlas = true;
+		m_pages.push_back(page);
+		pageImages[i]->drop();
+	}
+	m_driver->setTextureCreationFlag(ETCF_CREATE_MIP_MAPS, mipMaps);
+	if (!pageImages.empty())
+		m_whitePage = firstPage;
+
+	std::cout << "SpriteBatch: " << order.size() << " images packed into " << m_pages.size()
+		<< " atlas page(s) of " << pageSize << "x" << pageSize << std::endl;
+}
+
+dimension2du SpriteBatch::getSize(s32 sprite) const
+{
+	if (sprite < 0 || sprite >= (s32)m_sprites.size())
+		return dimension2du(0, 0);
+	return m_sprites[sprite].size;
+}
+
+s32 SpriteBatch::addPage(ITexture* texture)
+{
+	if (!texture)
+		return -1;
+
+	Page page;
+	page.texture = texture;
+	page.atlas = false;
+	m_pages.push_back(page);
+	return m_pages.size() - 1;
+}
+
+void SpriteBatch::draw(s32 sprite, const rect<s32>& dest, SColor color)
+{
+	if (sprite < 0 || sprite >= (s32)m_sprites.size() || m_sprites[sprite].page < 0)
+		return;
+
+	addQuad(m_sprites[sprite].page, dest, m_sprites[sprite].uv, color);
+}
+
+void SpriteBatch::drawRect(SColor color, const rect<s32>& dest)
+{
+	if (m_whitePage < 0)
+	{
+		m_driver->draw2DRectangle(color, dest);
+		return;
+	}
+
+	// Every atlas page has white texels; stay on the current one if possible
+	const s32 page = (m_currentPage >= 0 && m_pages[m_currentPage].atlas) ? m_currentPage : m_whitePage;
+	const vector2df white = m_pages[page].whiteUV;
+	addQuad(page, dest, rect<f32>(white, white), color);
+}
+
+void SpriteBatch::drawImage(s32 page, const rect<s32>& dest, const rect<f32>& uv, SColor color)
+{
+	if (page < 0 || page >= (s32)m_pages.size())
+		return;
+
+	addQuad(page, dest, uv, color);
+}
+
+void SpriteBatch::drawText(IGUIFont* font, const wchar_t* text, const rect<s32>& dest, SColor color,
+	bool hcenter, bool vcenter)
+{
+	if (!font)
+		return;
+
+	Text t = { font, text, dest, color, hcenter, vcenter };
+	m_texts.push_back(t);
+}
+
+void SpriteBatch::addQuad(s32 page, const rect<s32>& dest, const rect<f32>& uv, SColor color)
+{
+	if ((page != m_currentPage && !m_vertices.empty()) || m_vertices.size() / 4 >= MAX_BATCH_QUADS)
+		flushQuads();
+	m_currentPage = page;
+
+	const f32 x0 = (f32)dest.UpperLeftCorner.X, y0 = (f32)dest.UpperLeftCorner.Y;
+	const f32 x1 = (f32)dest.LowerRightCorner.X, y1 = (f32)dest.LowerRightCorner.Y;
+	const vector3df normal(0, 0, -1);
+	m_vertices.push_back(S3DVertex(vector3df(x0, y0, 0), normal, color, uv.UpperLeftCorner));
+	m_vertices.push_back(S3DVertex(vector3df(x1, y0, 0), normal, color, vector2df(uv.LowerRightCorner.X, uv.UpperLeftCorner.Y)));
+	m_vertices.push_back(S3DVertex(vector3df(x1, y1, 0), normal, color, uv.LowerRightCorner));
+	m_vertices.push_back(S3DVertex(vector3df(x0, y1, 0), normal, color, vector2df(uv.UpperLeftCorner.X, uv.LowerRightCorner.Y)));
+	m_quads++;
+}
+
+void SpriteBatch::flushQuads()
+{
+	const u32 quads = m_vertices.size() / 4;
+	if (quads == 0)
+		return;
+
+	// Index pattern only depends on the quad count; grow it on demand
+	for (u32 q = m_indices.size() / 6; q < quads; q++)
+	{
+		const u16 base = (u16)(q * 4);
+		m_indices.push_back(base);
+		m_indices.push_back(base + 1);
+		m_indices.push_back(base + 2);
+		m_indices.push_back(base);
+		m_indices.push_back(base + 2);
+		m_indices.push_back(base + 3);
+	}
+
+	// Pixel coordinates, mapped the same way the drivers set up their 2D mode
+	const matrix4 oldProjection = m_driver->getTransform(ETS_PROJECTION);
+	const matrix4 oldView = m_driver->getTransform(ETS_VIEW);
+	const matrix4 oldWorld = m_driver->getTransform(ETS_WORLD);
+	const dimension2du ss = m_driver->getCurrentRenderTargetSize();
+	matrix4 projection;
+	projection.buildProjectionMatrixOrthoLH((f32)ss.Width, -(f32)ss.Height, -1.0f, 1.0f);
+	projection.setTranslation(vector3df(-1, 1, 0));
+	m_driver->setTransform(ETS_PROJECTION, projection);
+	m_driver->setTransform(ETS_VIEW, IdentityMatrix);
+	m_driver->setTransform(ETS_WORLD, IdentityMatrix);
+
+	m_material.setTexture(0, m_pages[m_currentPage].texture);
+	m_driver->setMaterial(m_material);
+	m_driver->drawIndexedTriangleList(m_vertices.pointer(), m_vertices.size(), m_indices.pointer(), quads * 2);
+	m_binds++;
+
+	m_driver->setTransform(ETS_PROJECTION, oldProjection);
+	m_driver->setTransform(ETS_VIEW, oldView);
+	m_driver->setTransform(ETS_WORLD, oldWorld);
+	m_vertices.set_used(0);
+}
+
+void SpriteBatch::flush()
+{
+	flushQuads();
+
+	for (u32 i = 0; i < m_texts.size(); i++)
+	{
+		const Text& t = m_texts[i];
+		t.font->draw(t.text, t.dest, t.color, t.hcenter, t.vcenter);
+		m_binds++; // each font draw binds the font texture
+	}
+	m_texts.set_used(0);
+}
+
+void SpriteBatch::beginFrame()
+{
+	m_lastQuads = m_quads;
+	m_lastBinds = m_binds;
+	m_quads = 0;
+	m_binds = 0;
+	m_currentPage = -1;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <irrlicht.h>
+
+using namespace irr;
+using namespace core;
+using namespace video;
+using namespace gui;
+
+// 2D drawing for menus and HUD through a texture atlas. Images are added
+// once at startup and packed into atlas pages by build(); every draw call
+// after that only queues a quad. flush() submits the queue with one
+// triangle list per run of quads on the same page (solid rectangles use a
+// white texel on the current page, so they don't break a run). Queued text
+// is drawn after all quads of the same flush, so it always ends up on top.
+class SpriteBatch
+{
+public:
+	SpriteBatch(IVideoDriver* driver);
+	~SpriteBatch();
+
+	// Queues an image file for the atlas; returns its sprite id or -1
+	s32 add(const io::path& file);
+	void build();
+
+	dimension2du getSize(s32 sprite) const;
+
+	// Registers a texture that is not packed into the atlas (e.g. a font) as
+	// a page of its own; returns the page id for drawImage()
+	s32 addPage(ITexture* texture);
+
+	void draw(s32 sprite, const rect<s32>& dest, SColor color = SColor(255, 255, 255, 255));
+	void drawRect(SColor color, const rect<s32>& dest);
+	void drawImage(s32 page, const rect<s32>& dest, const rect<f32>& uv, SColor color = SColor(255, 255, 255, 255));
+	void drawText(IGUIFont* font, const wchar_t* text, const rect<s32>& dest, SColor color,
+		bool hcenter = false, bool vcenter = false);
+	void flush();
+
+	// Counters of the last finished frame
+	void beginFrame();
+	u32 getPageCount() const { return m_pages.size(); }
+	u32 getQuadCount() const { return m_lastQuads; }
+	u32 getTextureBinds() const { return m_lastBinds; }
+
+private:
+	struct Sprite
+	{
+		io::path file;
+		dimension2du size;
+		s32 page;
+		rect<f32> uv;
+	};
+
+	struct Page
+	{
+		ITexture* texture;
+		vector2df whiteUV; // center of the reserved white texels
+		bool atlas;        // built by us; added pages have no white texels
+	};
+
+	struct Text
+	{
+		IGUIFont* font;
+		stringw text;
+		rect<s32> dest;
+		SColor color;
+		bool hcenter;
+		bool vcenter;
+	};
+
+	void addQuad(s32 page, const rect<s32>& dest, const rect<f32>& uv, SColor color);
+	void flushQuads();
+
+	IVideoDriver*     m_driver;
+	array<Sprite>     m_sprites;
+	array<Page>       m_pages;
+	array<S3DVertex>  m_vertices;
+	array<u16>        m_indices;
+	array<Text>       m_texts;
+	SMaterial         m_material;
+	s32               m_currentPage;
+	s32               m_whitePage; // first atlas page, -1 before build()
+
+	u32 m_quads, m_binds;
+	u32 m_lastQuads, m_lastBinds;
+};
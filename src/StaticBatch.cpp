@@ -0,0 +1,105 @@
+#include "StaticBatch.h"
+
+static const u32 MAX_BATCH_VERTICES = 65535;
+
+// Absolute transforms are normally refreshed during drawAll(); nodes created
+// this frame still have stale ones, so update the chain from the root down
+static void updateAncestors(ISceneNode* node)
+{
+	if (node->getParent())
+		updateAncestors(node->getParent());
+	node->updateAbsolutePosition();
+}
+
+StaticBatch::StaticBatch()
+	: m_mesh(new SMesh())
+	, m_drawCallsBefore(0)
+	, m_optimizeStats()
+{
+}
+
+StaticBatch::~StaticBatch()
+{
+	m_mesh->drop();
+}
+
+void StaticBatch::add(ISceneNode* node)
+{
+	if (!node)
+		return;
+
+	if (node->getParent())
+		updateAncestors(node->getParent());
+	bakeNode(node);
+	node->remove();
+}
+
+void StaticBatch::bakeNode(ISceneNode* node)
+{
+	node->updateAbsolutePosition();
+
+	if (node->getType() == ESNT_MESH || node->getType() == ESNT_CUBE)
+	{
+		IMesh* mesh = static_cast<IMeshSceneNode*>(node)->getMesh();
+		const matrix4& transform = node->getAbsoluteTransformation();
+
+		for (u32 b = 0; mesh && b < mesh->getMeshBufferCount(); b++)
+		{
+			IMeshBuffer* src = mesh->getMeshBuffer(b);
+			if (src->getVertexType() != EVT_STANDARD || src->getIndexType() != EIT_16BIT)
+				continue;
+
+			SMeshBuffer* dst = getBuffer(node->getMaterial(b), src->getVertexCount());
+			const S3DVertex* vertices = static_cast<const S3DVertex*>(src->getVertices());
+			const u16* indices = src->getIndices();
+			const u32 base = dst->Vertices.size();
+
+			for (u32 v = 0; v < src->getVertexCount(); v++)
+			{
+				S3DVertex vertex = vertices[v];
+				transform.transformVect(vertex.Pos);
+				transform.rotateVect(vertex.Normal);
+				vertex.Normal.normalize();
+				dst->Vertices.push_back(vertex);
+			}
+			for (u32 i = 0; i < src->getIndexCount(); i++)
+				dst->Indices.push_back((u16)(base + indices[i]));
+
+			m_drawCallsBefore++;
+		}
+	}
+
+	const list<ISceneNode*>& children = node->getChildren();
+	for (list<ISceneNode*>::ConstIterator it = children.begin(); it != children.end(); ++it)
+		bakeNode(*it);
+}
+
+SMeshBuffer* StaticBatch::getBuffer(const SMaterial& material, u32 vertexCount)
+{
+	for (u32 i = 0; i < m_mesh->getMeshBufferCount(); i++)
+	{
+		SMeshBuffer* buffer = static_cast<SMeshBuffer*>(m_mesh->getMeshBuffer(i));
+		if (buffer->Material == material && buffer->Vertices.size() + vertexCount <= MAX_BATCH_VERTICES)
+			return buffer;
+	}
+
+	SMeshBuffer* buffer = new SMeshBuffer();
+	buffer->Material = material;
+	m_mesh->addMeshBuffer(buffer);
+	buffer->drop();
+	return buffer;
+}
+
+IMeshSceneNode* StaticBatch::build(ISceneManager* smgr)
+{
+	SMesh* optimized = MeshOptimizer::optimize(m_mesh, &m_optimizeStats);
+	m_mesh->drop();
+	m_mesh = optimized;
+
+	for (u32 i = 0; i < m_mesh->getMeshBufferCount(); i++)
+		m_mesh->getMeshBuffer(i)->recalculateBoundingBox();
+	m_mesh->recalculateBoundingBox();
+	m_mesh->setHardwareMappingHint(EHM_STATIC);
+
+	return smgr->addMeshSceneNode(m_mesh);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <irrlicht.h>
+#include "MeshOptimizer.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+// Bakes static mesh scene nodes into a few world-space mesh buffers, one per
+// distinct material (split when a buffer would pass 65535 vertices), and
+// renders them from a single node. Used for the obstacles and gate dressing,
+// which never move after setup. The baked buffers are welded and vertex
+// cache ordered by MeshOptimizer when the node is built.
+class StaticBatch
+{
+public:
+	StaticBatch();
+	~StaticBatch();
+
+	// Copies the geometry of node and its whole subtree (mesh and cube nodes)
+	// into the batch with their current transforms, then removes the nodes
+	void add(ISceneNode* node);
+
+	// Creates the node rendering the batch; call once after all add() calls
+	IMeshSceneNode* build(ISceneManager* smgr);
+
+	u32 getDrawCallsBefore() const { return m_drawCallsBefore; }
+	u32 getDrawCallsAfter() const { return m_mesh->getMeshBufferCount(); }
+	const MeshOptimizer::Stats& getOptimizeStats() const { return m_optimizeStats; }
+
+private:
+	void bakeNode(ISceneNode* node);
+	SMeshBuffer* getBuffer(const SMaterial& material, u32 vertexCount);
+
+	SMesh* m_mesh;
+	u32    m_drawCallsBefore;
+	MeshOptimizer::Stats m_optimizeStats;
+};
@@ -0,0 +1,40 @@
+#include "StaticCollision.h"
+
+StaticCollision::StaticCollision()
+	: m_shape(nullptr)
+{
+}
+
+StaticCollision::~StaticCollision()
+{
+	// The body belongs to Physics, but the shapes are ours
+	if (m_shape)
+	{
+		for (int i = m_shape->getNumChildShapes() - 1; i >= 0; i--)
+			delete m_shape->getChildShape(i);
+		delete m_shape;
+	}
+}
+
+void StaticCollision::addBox(const vector3df& halfExtents, const vector3df& position, f32 rotationYDeg)
+{
+	Child child;
+	child.halfExtents = toBullet(halfExtents);
+	child.transform.setIdentity();
+	child.transform.setOrigin(toBullet(position));
+	if (rotationYDeg != 0.0f)
+		child.transform.setRotation(btQuaternion(btVector3(0, 1, 0), rotationYDeg * core::DEGTORAD));
+	m_children.push_back(child);
+}
+
+btRigidBody* StaticCollision::build(Physics* physics)
+{
+	if (m_shape || m_children.size() == 0)
+		return nullptr;
+
+	m_shape = new btCompoundShape(true, m_children.size());
+	for (int i = 0; i < m_children.size(); i++)
+		m_shape->addChildShape(m_children[i].transform, new btBoxShape(m_children[i].halfExtents));
+
+	return physics->createRigidBody(0.0f, m_shape, vector3df(0, 0, 0));
+}
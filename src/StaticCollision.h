@@ -0,0 +1,34 @@
+#pragma once
+#include <btBulletDynamicsCommon.h>
+#include <irrlicht.h>
+#include "Physics.h"
+
+using namespace irr;
+using namespace core;
+
+// All static arena collision (ground, walls, obstacles) merged into a single
+// btCompoundShape on one rigid body, so the broadphase holds one proxy instead
+// of one per box.
+class StaticCollision
+{
+public:
+	StaticCollision();
+	~StaticCollision();
+
+	void addBox(const vector3df& halfExtents, const vector3df& position, f32 rotationYDeg = 0.0f);
+
+	// Builds the compound body from the current child list and adds it to the world
+	btRigidBody* build(Physics* physics);
+
+	int getChildCount() const { return m_children.size(); }
+
+private:
+	struct Child
+	{
+		btVector3 halfExtents;
+		btTransform transform;
+	};
+
+	btAlignedObjectArray<Child> m_children;
+	btCompoundShape* m_shape;
+};
@@ -0,0 +1,145 @@
+#include "UniformGridBroadphase.h"
+
+// Proxies spanning more cells than this skip the grid
+static const int MAX_CELLS_PER_PROXY = 16;
+
+// Removes cached pairs whose AABBs no longer overlap. The grid pass only
+// visits proxies that share a cell, so it never sees separated pairs itself.
+struct RemoveSeparatedPairsCallback : public btOverlapCallback
+{
+	bool processOverlap(btBroadphasePair& pair) override
+	{
+		return !btSimpleBroadphase::aabbOverlap(
+			static_cast<btSimpleBroadphaseProxy*>(pair.m_pProxy0),
+			static_cast<btSimpleBroadphaseProxy*>(pair.m_pProxy1));
+	}
+};
+
+UniformGridBroadphase::UniformGridBroadphase(const btVector3& worldMin, const btVector3& worldMax,
+	btScalar cellSize, int maxProxies)
+	: btSimpleBroadphase(maxProxies)
+	, m_worldMin(worldMin)
+	, m_worldMax(worldMax)
+	, m_invCellSize(btScalar(1.0) / cellSize)
+{
+	m_cellsX = (int)((worldMax.getX() - worldMin.getX()) * m_invCellSize) + 1;
+	m_cellsZ = (int)((worldMax.getZ() - worldMin.getZ()) * m_invCellSize) + 1;
+	m_cellStart.resize(m_cellsX * m_cellsZ + 1, 0);
+	m_cellCursor.resize(m_cellsX * m_cellsZ, 0);
+	m_isOversized.resize(maxProxies, false);
+}
+
+int UniformGridBroadphase::cellX(btScalar x) const
+{
+	int c = (int)((x - m_worldMin.getX()) * m_invCellSize);
+	return c < 0 ? 0 : (c >= m_cellsX ? m_cellsX - 1 : c);
+}
+
+int UniformGridBroadphase::cellZ(btScalar z) const
+{
+	int c = (int)((z - m_worldMin.getZ()) * m_invCellSize);
+	return c < 0 ? 0 : (c >= m_cellsZ ? m_cellsZ - 1 : c);
+}
+
+void UniformGridBroadphase::calculateOverlappingPairs(btDispatcher* dispatcher)
+{
+	RemoveSeparatedPairsCallback removeSeparated;
+	m_pairCache->processAllOverlappingPairs(&removeSeparated, dispatcher);
+
+	const int numCells = m_cellsX * m_cellsZ;
+	for (int c = 0; c <= numCells; c++)
+		m_cellStart[c] = 0;
+	m_oversized.resize(0);
+
+	// Count proxies per cell (stored shifted by one for the prefix sum)
+	int newLargestIndex = -1;
+	for (int i = 0; i <= m_LastHandleIndex; i++)
+	{
+		btSimpleBroadphaseProxy* proxy = &m_pHandles[i];
+		m_isOversized[i] = false;
+		if (!proxy->m_clientObject)
+			continue;
+		newLargestIndex = i;
+
+		int x0 = cellX(proxy->m_aabbMin.getX()), x1 = cellX(proxy->m_aabbMax.getX());
+		int z0 = cellZ(proxy->m_aabbMin.getZ()), z1 = cellZ(proxy->m_aabbMax.getZ());
+		if ((x1 - x0 + 1) * (z1 - z0 + 1) > MAX_CELLS_PER_PROXY)
+		{
+			m_isOversized[i] = true;
+			m_oversized.push_back(i);
+			continue;
+		}
+
+		for (int z = z0; z <= z1; z++)
+			for (int x = x0; x <= x1; x++)
+				m_cellStart[z * m_cellsX + x + 1]++;
+	}
+	m_LastHandleIndex = newLargestIndex;
+
+	for (int c = 0; c < numCells; c++)
+	{
+		m_cellStart[c + 1] += m_cellStart[c];
+		m_cellCursor[c] = m_cellStart[c];
+	}
+	m_cellEntries.resize(m_cellStart[numCells]);
+
+	for (int i = 0; i <= m_LastHandleIndex; i++)
+	{
+		btSimpleBroadphaseProxy* proxy = &m_pHandles[i];
+		if (!proxy->m_clientObject || m_isOversized[i])
+			continue;
+
+		int x0 = cellX(proxy->m_aabbMin.getX()), x1 = cellX(proxy->m_aabbMax.getX());
+		int z0 = cellZ(proxy->m_aabbMin.getZ()), z1 = cellZ(proxy->m_aabbMax.getZ());
+		for (int z = z0; z <= z1; z++)
+			for (int x = x0; x <= x1; x++)
+				m_cellEntries[m_cellCursor[z * m_cellsX + x]++] = i;
+	}
+
+	// Pairs within a cell. Two proxies can share several cells, so a pair is
+	// only reported by the cell holding the min corner of their overlap.
+	for (int c = 0; c < numCells; c++)
+	{
+		const int begin = m_cellStart[c], end = m_cellStart[c + 1];
+		for (int a = begin; a < end; a++)
+		{
+			btSimpleBroadphaseProxy* p0 = &m_pHandles[m_cellEntries[a]];
+			for (int b = a + 1; b < end; b++)
+			{
+				btSimpleBroadphaseProxy* p1 = &m_pHandles[m_cellEntries[b]];
+				if (!aabbOverlap(p0, p1))
+					continue;
+
+				btScalar minX = btMax(p0->m_aabbMin.getX(), p1->m_aabbMin.getX());
+				btScalar minZ = btMax(p0->m_aabbMin.getZ(), p1->m_aabbMin.getZ());
+				if (cellZ(minZ) * m_cellsX + cellX(minX) != c)
+					continue;
+
+				if (!m_pairCache->findPair(p0, p1))
+					m_pairCache->addOverlappingPair(p0, p1);
+			}
+		}
+	}
+
+	// Oversized proxies against everything else
+	for (int n = 0; n < m_oversized.size(); n++)
+	{
+		const int i = m_oversized[n];
+		btSimpleBroadphaseProxy* p0 = &m_pHandles[i];
+		for (int j = 0; j <= m_LastHandleIndex; j++)
+		{
+			btSimpleBroadphaseProxy* p1 = &m_pHandles[j];
+			if (j == i || !p1->m_clientObject || (m_isOversized[j] && j < i))
+				continue;
+
+			if (aabbOverlap(p0, p1) && !m_pairCache->findPair(p0, p1))
+				m_pairCache->addOverlappingPair(p0, p1);
+		}
+	}
+}
+
+void UniformGridBroadphase::getBroadphaseAabb(btVector3& aabbMin, btVector3& aabbMax) const
+{
+	aabbMin = m_worldMin;
+	aabbMax = m_worldMax;
+}
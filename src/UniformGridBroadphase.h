@@ -0,0 +1,36 @@
+#pragma once
+#include <btBulletCollisionCommon.h>
+#include <BulletCollision/BroadphaseCollision/btSimpleBroadphase.h>
+
+// Broadphase for a flat, bounded arena: proxies are binned into a uniform
+// XZ grid and only proxies sharing a cell are tested against each other.
+// Proxies that cover many cells (the static arena compound) are kept in a
+// separate list and tested against everything. Proxy storage, ray and AABB
+// queries come from btSimpleBroadphase.
+class UniformGridBroadphase : public btSimpleBroadphase
+{
+public:
+	UniformGridBroadphase(const btVector3& worldMin, const btVector3& worldMax,
+		btScalar cellSize, int maxProxies = 4096);
+
+	void calculateOverlappingPairs(btDispatcher* dispatcher) override;
+	void getBroadphaseAabb(btVector3& aabbMin, btVector3& aabbMax) const override;
+
+private:
+	int cellX(btScalar x) const;
+	int cellZ(btScalar z) const;
+
+	btVector3 m_worldMin;
+	btVector3 m_worldMax;
+	btScalar  m_invCellSize;
+	int       m_cellsX;
+	int       m_cellsZ;
+
+	// Per-frame bins, reused between frames: proxies of cell c are
+	// m_cellEntries[m_cellStart[c] .. m_cellStart[c + 1])
+	btAlignedObjectArray<int> m_cellStart;
+	btAlignedObjectArray<int> m_cellCursor;
+	btAlignedObjectArray<int> m_cellEntries;
+	btAlignedObjectArray<int> m_oversized;
+	btAlignedObjectArray<bool> m_isOversized;
+};
@@ -1,8 +1,49 @@
 ﻿#include "Game.h"
+#include "Benchmark.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
-int main()
+int main(int argc, char* argv[])
 {
-	Game game;
+	PhysicsConfig physicsConfig;
+	RenderConfig renderConfig;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bench-physics-threads") == 0)
+			return Benchmark::runPhysicsThreads();
+		if (strcmp(argv[i], "--physics-threads") == 0 && i + 1 < argc)
+			physicsConfig.numThreads = atoi(argv[++i]);
+		if (strcmp(argv[i], "--bench-md2") == 0)
+			return Benchmark::runMD2Interpolation();
+		if (strcmp(argv[i], "--bench-software") == 0)
+			return Benchmark::runSoftwareRaster();
+		if (strcmp(argv[i], "--bench-render") == 0)
+			return Benchmark::runRenderFrames(i + 1 < argc && strcmp(argv[i + 1], "--update-golden") == 0);
+		if (strcmp(argv[i], "--stencil-shadows") == 0)
+			renderConfig.stencilShadows = true;
+		if (strcmp(argv[i], "--fixed-quality") == 0)
+			renderConfig.adaptiveQuality = false;
+		if (strcmp(argv[i], "--target-fps") == 0 && i + 1 < argc)
+		{
+			int fps = atoi(argv[++i]);
+			if (fps > 0)
+				renderConfig.targetFrameTime = 1.0f / fps;
+		}
+		if (strcmp(argv[i], "--bench-broadphase") == 0)
+			return Benchmark::runBroadphase();
+		if (strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc)
+		{
+			if (!parseBroadphaseName(argv[++i], physicsConfig.broadphase))
+			{
+				printf("Unknown broadphase '%s' (dbvt, sap, sap32, grid)\n", argv[i]);
+				return 1;
+			}
+		}
+	}
+
+	Game game(physicsConfig, renderConfig);
 	game.run();
 	return 0;
 }